@@ -0,0 +1,247 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file Bench.cpp
+///
+/// \brief	Small helpers shared by the benchmark executables
+// ###########################################################################
+
+#include "Bench.h"
+#include "libWizium.h"
+
+#include <algorithm>
+#include <math.h>
+
+#ifdef PL_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+// ###########################################################################
+//
+// P U B L I C
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Return a percentile of the samples, by linear interpolation
+///
+/// \param	p	Percentile to compute, in [0..100]
+///
+/// \return	Percentile value, 0 if there is no sample
+// ===========================================================================
+double Bench::Samples::Percentile (double p)
+{
+	if (values.empty ()) return 0;
+	if (!sorted) std::sort (values.begin (), values.end ());
+	sorted = true;
+
+	double rank = p / 100.0 * (values.size () -1);
+	size_t low = (size_t) floor (rank);
+	size_t high = (size_t) ceil (rank);
+
+	return values [low] + (values [high] - values [low]) * (rank - low);
+}
+
+
+// ===========================================================================
+/// \brief	Return the mean of the samples, 0 if there is none
+// ===========================================================================
+double Bench::Samples::Mean () const
+{
+	if (values.empty ()) return 0;
+
+	double sum = 0;
+	for (double v : values) sum += v;
+	return sum / values.size ();
+}
+
+
+// ===========================================================================
+/// \brief	Open a JSON object
+///
+/// \param	key		Key of the object in its parent. Null for an array element or the root
+// ===========================================================================
+void Bench::Json::BeginObject (const char* key)
+{
+	Key (key);
+	fprintf (out, "{");
+	depth ++;
+	first = true;
+}
+
+
+// ===========================================================================
+/// \brief	Close the current JSON object
+// ===========================================================================
+void Bench::Json::EndObject ()
+{
+	depth --;
+	if (!first) Indent ();
+	fprintf (out, "}");
+	if (depth == 0) fprintf (out, "\n");
+	first = false;
+}
+
+
+// ===========================================================================
+/// \brief	Open a JSON array
+///
+/// \param	key		Key of the array in its parent. Null for an array element or the root
+// ===========================================================================
+void Bench::Json::BeginArray (const char* key)
+{
+	Key (key);
+	fprintf (out, "[");
+	depth ++;
+	first = true;
+}
+
+
+// ===========================================================================
+/// \brief	Close the current JSON array
+// ===========================================================================
+void Bench::Json::EndArray ()
+{
+	depth --;
+	if (!first) Indent ();
+	fprintf (out, "]");
+	if (depth == 0) fprintf (out, "\n");
+	first = false;
+}
+
+
+// ===========================================================================
+/// \brief	Write a string value. The string is not escaped.
+// ===========================================================================
+void Bench::Json::Value (const char* key, const char* value)
+{
+	Key (key);
+	fprintf (out, "\"%s\"", value);
+}
+
+
+// ===========================================================================
+/// \brief	Write a number. Non finite numbers are written as null.
+// ===========================================================================
+void Bench::Json::Value (const char* key, double value)
+{
+	Key (key);
+	if (isfinite (value)) fprintf (out, "%.4f", value);
+	else fprintf (out, "null");
+}
+
+
+// ===========================================================================
+/// \brief	Write an integer
+// ===========================================================================
+void Bench::Json::Value (const char* key, int64_t value)
+{
+	Key (key);
+	fprintf (out, "%lld", (long long) value);
+}
+
+
+// ===========================================================================
+/// \brief	Write an unsigned integer
+// ===========================================================================
+void Bench::Json::Value (const char* key, uint64_t value)
+{
+	Key (key);
+	fprintf (out, "%llu", (unsigned long long) value);
+}
+
+
+// ===========================================================================
+/// \brief	Write a boolean
+// ===========================================================================
+void Bench::Json::Value (const char* key, bool value)
+{
+	Key (key);
+	fprintf (out, value ? "true" : "false");
+}
+
+
+// ===========================================================================
+/// \brief	Return the peak resident set size of the process
+///
+/// \return	Peak memory usage [kB], 0 if unknown on this platform
+// ===========================================================================
+uint64_t Bench::PeakRssKb ()
+{
+#ifdef PL_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo (GetCurrentProcess (), &counters, sizeof (counters))) return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage (RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+
+// ===========================================================================
+/// \brief	Concatenate a directory and a file name
+// ===========================================================================
+std::string Bench::JoinPath (const std::string& dir, const char* file)
+{
+	if (dir.empty ()) return file;
+
+	char last = dir.back ();
+	if (last == '/' || last == '\\') return dir + file;
+	return dir + "/" + file;
+}
+
+
+// ###########################################################################
+//
+// P R I V A T E
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Write the separator and the key of the next element
+///
+/// \param	key		Key of the element. Null for an array element or the root
+// ===========================================================================
+void Bench::Json::Key (const char* key)
+{
+	if (depth == 0) return;
+	if (!first) fprintf (out, ",");
+	Indent ();
+	first = false;
+
+	if (key != nullptr) fprintf (out, "\"%s\": ", key);
+}
+
+
+// ===========================================================================
+/// \brief	Go to the next line, at the current depth
+// ===========================================================================
+void Bench::Json::Indent ()
+{
+	fprintf (out, "\n");
+	for (int i = 0; i < depth; i ++) fprintf (out, "  ");
+}
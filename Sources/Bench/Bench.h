@@ -0,0 +1,104 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file Bench.h
+///
+/// \brief	Small helpers shared by the benchmark executables
+// ###########################################################################
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+// ###########################################################################
+//
+// P R O T O T Y P E S
+//
+// ###########################################################################
+
+namespace Bench
+{
+	/// Monotonic stopwatch
+	class Timer
+	{
+	public:
+		Timer () { Restart (); }
+		void Restart () { start = std::chrono::steady_clock::now (); }
+
+		double ElapsedMs () const
+		{
+			return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - start).count ();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/// Latency samples, summarized by a few percentiles
+	class Samples
+	{
+	public:
+		void Add (double value) { values.push_back (value); sorted = false; }
+		void Clear () { values.clear (); }
+		size_t Count () const { return values.size (); }
+
+		double Percentile (double p);
+		double Mean () const;
+
+	private:
+		std::vector<double> values;
+		bool sorted = false;
+	};
+
+	/// Minimal JSON writer, good enough for flat reports of numbers and strings
+	class Json
+	{
+	public:
+		Json (FILE* out) : out (out), depth (0), first (true) {}
+
+		void BeginObject (const char* key = nullptr);
+		void EndObject ();
+		void BeginArray (const char* key = nullptr);
+		void EndArray ();
+
+		void Value (const char* key, const char* value);
+		void Value (const char* key, double value);
+		void Value (const char* key, int64_t value);
+		void Value (const char* key, uint64_t value);
+		void Value (const char* key, int value) { Value (key, (int64_t) value); }
+		void Value (const char* key, bool value);
+
+	private:
+		void Key (const char* key);
+		void Indent ();
+
+		FILE* out;
+		int depth;
+		bool first;
+	};
+
+	uint64_t PeakRssKb ();
+	std::string JoinPath (const std::string& dir, const char* file);
+}
+
+#endif
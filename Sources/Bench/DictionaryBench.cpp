@@ -0,0 +1,491 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file DictionaryBench.cpp
+///
+/// \brief	Dictionary micro-benchmark: build cost, then FindEntry and FindRandomEntry
+///			latency for several mask classes, per word length, with and without
+///			letter candidates. The results are reported as JSON.
+///
+/// Usage: wizium_dictionary_bench [--dict-dir DIR] [--queries N] [--layout dense|compact|both]
+///									[--output FILE]
+// ###########################################################################
+
+#include "Dictionary/Dictionary.h"
+#include "Utils/Random.h"
+#include "Bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIZIUM_DICTIONARY_DIR
+#define WIZIUM_DICTIONARY_DIR "../Dictionaries"
+#endif
+
+
+// ===========================================================================
+// D E F I N E
+// ===========================================================================
+
+/// Number of chunks used to measure the pools growth
+#define NUM_CHUNKS			10
+
+/// Word lengths with fewer words are not measured
+#define MIN_WORDS_BY_LENGTH	50
+
+/// Letters allowed by a position filter, in addition to the one of the source word
+#define CANDIDATE_LETTERS	8
+
+
+
+// ###########################################################################
+//
+// T Y P E S
+//
+// ###########################################################################
+
+/// Mask classes
+enum MaskClass
+{
+	ALL_WILDCARD,		///< "*****"
+	PREFIX,				///< First third of the letters fixed
+	SUFFIX,				///< Last third of the letters fixed
+	SPARSE,				///< Two interior letters fixed
+	NO_MATCH,			///< Like SPARSE, but nothing matches
+	NUM_CLASSES
+};
+
+static const char* classNames [NUM_CLASSES] = {"all_wildcard", "prefix", "suffix", "sparse", "no_match"};
+
+/// A prepared query
+struct Query
+{
+	uint8_t mask [MAX_WORD_LENGTH+1];
+	LetterCandidates candidates [MAX_WORD_LENGTH];
+};
+
+/// Word list of a file, as fixed size upper case entries
+struct WordList
+{
+	std::vector<uint8_t> entries;						///< Zero padded entries, followed by an empty one
+	int entrySize = 0;									///< Size of an entry
+	int numWords = 0;									///< Number of words
+	std::vector<std::vector<std::string>> byLength;		///< Words sorted by length
+};
+
+/// Benchmark options
+struct Options
+{
+	std::string dictionaryDir = WIZIUM_DICTIONARY_DIR;
+	int queries = 1000;
+	bool dense = true;
+	bool compact = true;
+	const char* output = nullptr;
+};
+
+static const char* dictionaries [] = {"Fr_ODS4.txt", "Fr_Simple.txt"};
+
+
+// ###########################################################################
+//
+// W O R D S   A N D   Q U E R I E S
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Read a word list file, keeping the lines made of ASCII letters only
+///
+/// \param	path		File to read
+/// \param	list		Resulting list
+///
+/// \return	False if the file cannot be read
+// ===========================================================================
+static bool ReadWords (const std::string& path, WordList& list)
+{
+	FILE* file = fopen (path.c_str (), "rb");
+	if (file == nullptr) return false;
+
+	std::vector<std::string> words;
+	char line [256];
+	size_t maxLen = 0;
+
+	while (fgets (line, sizeof (line), file) != nullptr)
+	{
+		std::string word;
+		bool valid = true;
+
+		for (char* p = line; *p != 0 && *p != '\n' && *p != '\r'; p ++)
+		{
+			if (*p >= 'a' && *p <= 'z') word += (char) (*p + 'A' - 'a');
+			else if (*p >= 'A' && *p <= 'Z') word += *p;
+			else valid = false;
+		}
+
+		if (!valid || word.empty () || word.size () > MAX_WORD_LENGTH) continue;
+		if (word.size () > maxLen) maxLen = word.size ();
+		words.push_back (word);
+	}
+	fclose (file);
+
+	list.entrySize = (int) maxLen;
+	list.numWords = (int) words.size ();
+	list.entries.assign ((words.size () +1) * maxLen, 0);
+	list.byLength.assign (maxLen +1, std::vector<std::string> ());
+
+	for (size_t i = 0; i < words.size (); i ++)
+	{
+		memcpy (&list.entries [i * maxLen], words [i].data (), words [i].size ());
+		list.byLength [words [i].size ()].push_back (words [i]);
+	}
+
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Prepare a query of a given class, from a word of the dictionary
+///
+/// \param	dico		Dictionary, used to check the no-match masks
+/// \param	words		Words of the wanted length
+/// \param	maskClass	Mask class
+/// \param	rng			Random generator
+/// \param	query		Resulting query
+///
+/// \return	False if no query of this class could be found
+// ===========================================================================
+static bool MakeQuery (const Dictionary& dico, const std::vector<std::string>& words, MaskClass maskClass, Random& rng, Query& query)
+{
+	for (int attempt = 0; attempt < 1000; attempt ++)
+	{
+		const std::string& word = words [rng.Below ((uint32_t) words.size ())];
+		int len = (int) word.size ();
+		int fixed = len / 3 > 0 ? len / 3 : 1;
+
+		memset (query.mask, '*', len);
+		query.mask [len] = 0;
+
+		// Position filters always let the source word pass
+		for (int i = 0; i < len; i ++)
+		{
+			query.candidates [i].Reset (false);
+			for (int j = 0; j < CANDIDATE_LETTERS; j ++) query.candidates [i].flags |= 1ULL << rng.Below (26);
+			query.candidates [i].flags |= 1ULL << (word [i] - 'A');
+		}
+
+		switch (maskClass)
+		{
+		case ALL_WILDCARD:
+			return true;
+
+		case PREFIX:
+			memcpy (query.mask, word.data (), fixed);
+			return true;
+
+		case SUFFIX:
+			memcpy (query.mask + len - fixed, word.data () + len - fixed, fixed);
+			return true;
+
+		case SPARSE:
+		case NO_MATCH:
+		{
+			// Two distinct interior positions, or a single one for the short words
+			int p1 = len > 2 ? 1 + rng.Below (len -2) : rng.Below (len);
+			int p2 = len > 3 ? 1 + rng.Below (len -2) : p1;
+			while (len > 3 && p2 == p1) p2 = 1 + rng.Below (len -2);
+
+			query.mask [p1] = word [p1];
+			query.mask [p2] = word [p2];
+			if (maskClass == SPARSE) return true;
+
+			// Change the fixed letters until nothing matches
+			query.mask [p1] = (uint8_t) ('A' + rng.Below (26));
+			query.mask [p2] = (uint8_t) ('A' + rng.Below (26));
+			if (dico.CountMatches (query.mask, nullptr, 1) == 0) return true;
+			break;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	return false;
+}
+
+
+// ###########################################################################
+//
+// B E N C H M A R K
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Write the summary of latency samples
+// ===========================================================================
+static void WriteLatency (Bench::Json& json, const char* key, Bench::Samples& samples, int matches)
+{
+	json.BeginObject (key);
+	json.Value ("queries", (int) samples.Count ());
+	json.Value ("match_rate", samples.Count () > 0 ? (double) matches / samples.Count () : 0.0);
+	json.Value ("mean_ns", samples.Mean ());
+	json.Value ("p50_ns", samples.Percentile (50));
+	json.Value ("p90_ns", samples.Percentile (90));
+	json.Value ("p99_ns", samples.Percentile (99));
+	json.EndObject ();
+}
+
+
+// ===========================================================================
+/// \brief	Measure the cost of building the dictionary
+///
+/// \param	list		Word list
+/// \param	path		File holding the word list
+/// \param	layout		Dictionary layout
+/// \param	json		Report
+// ===========================================================================
+static void RunBuild (const WordList& list, const std::string& path, Dictionary::Layout layout, Bench::Json& json)
+{
+	Bench::Timer timer;
+
+	// The whole list in a single call, in the file order
+	Dictionary dico (26, list.entrySize, layout);
+	timer.Restart ();
+	int32_t added = dico.AddEntries (list.entries.data (), list.entrySize, list.numWords);
+	double addMs = timer.ElapsedMs ();
+
+	// Same words again: no node is created, so the difference is the allocation cost
+	timer.Restart ();
+	dico.AddEntries (list.entries.data (), list.entrySize, list.numWords);
+	double duplicateMs = timer.ElapsedMs ();
+
+	// Sorted batches from the file
+	Dictionary fromFile (26, list.entrySize, layout);
+	timer.Restart ();
+	fromFile.LoadFromFile (path.c_str ());
+	double loadMs = timer.ElapsedMs ();
+
+	json.BeginObject ("build");
+	json.Value ("words", added);
+	json.Value ("add_entries_ms", addMs);
+	json.Value ("add_entries_words_per_sec", addMs > 0 ? added * 1000.0 / addMs : 0.0);
+	json.Value ("duplicate_pass_ms", duplicateMs);
+	json.Value ("load_file_ms", loadMs);
+	json.Value ("memory_bytes", (uint64_t) dico.GetMemoryUsage ());
+	json.Value ("load_file_memory_bytes", (uint64_t) fromFile.GetMemoryUsage ());
+
+	// Growth of the pools, by chunks of the list
+	Dictionary growing (26, list.entrySize, layout);
+	json.BeginArray ("chunks");
+	for (int c = 0; c < NUM_CHUNKS; c ++)
+	{
+		int first = (int) ((int64_t) list.numWords * c / NUM_CHUNKS);
+		int last = (int) ((int64_t) list.numWords * (c+1) / NUM_CHUNKS);
+
+		timer.Restart ();
+		growing.AddEntries (&list.entries [(size_t) first * list.entrySize], list.entrySize, last - first);
+		double chunkMs = timer.ElapsedMs ();
+
+		json.BeginObject ();
+		json.Value ("words", last - first);
+		json.Value ("time_ms", chunkMs);
+		json.Value ("memory_bytes", (uint64_t) growing.GetMemoryUsage ());
+		json.EndObject ();
+	}
+	json.EndArray ();
+	json.EndObject ();
+}
+
+
+// ===========================================================================
+/// \brief	Measure the queries latency, per word length and mask class
+///
+/// \param	dico		Dictionary to query
+/// \param	list		Word list used to fill the dictionary
+/// \param	options		Benchmark options
+/// \param	json		Report
+// ===========================================================================
+static void RunQueries (const Dictionary& dico, const WordList& list, const Options& options, Bench::Json& json)
+{
+	Random rng (1);
+	std::vector<Query> queries (options.queries);
+	uint8_t result [MAX_WORD_LENGTH+1];
+
+	json.BeginArray ("queries");
+
+	for (int len = 2; len <= list.entrySize; len ++)
+	{
+		const std::vector<std::string>& words = list.byLength [len];
+		if (words.size () < MIN_WORDS_BY_LENGTH) continue;
+
+		for (int c = 0; c < NUM_CLASSES; c ++)
+		{
+			// Same queries for every variant
+			int numQueries = 0;
+			for (Query& query : queries)
+			{
+				if (!MakeQuery (dico, words, (MaskClass) c, rng, query)) break;
+				numQueries ++;
+			}
+			if (numQueries == 0) continue;
+
+			for (int withCandidates = 0; withCandidates < 2; withCandidates ++)
+			{
+				Bench::Samples findTimes, randomTimes;
+				int findMatches = 0, randomMatches = 0;
+
+				for (int i = 0; i < numQueries; i ++)
+				{
+					const LetterCandidates* candidates = withCandidates ? queries [i].candidates : nullptr;
+
+					Bench::Timer timer;
+					bool found = dico.FindEntry (result, queries [i].mask, nullptr, candidates);
+					findTimes.Add (timer.ElapsedMs () * 1e6);
+					findMatches += found;
+
+					timer.Restart ();
+					found = dico.FindRandomEntry (result, queries [i].mask, rng, candidates);
+					randomTimes.Add (timer.ElapsedMs () * 1e6);
+					randomMatches += found;
+				}
+
+				json.BeginObject ();
+				json.Value ("length", len);
+				json.Value ("class", classNames [c]);
+				json.Value ("candidates", withCandidates != 0);
+				WriteLatency (json, "find_entry", findTimes, findMatches);
+				WriteLatency (json, "find_random_entry", randomTimes, randomMatches);
+				json.EndObject ();
+			}
+		}
+	}
+
+	json.EndArray ();
+}
+
+
+// ===========================================================================
+/// \brief	Run the whole benchmark on a dictionary file
+///
+/// \param	name		Dictionary file name
+/// \param	options		Benchmark options
+/// \param	json		Report
+///
+/// \return	False if the file cannot be read
+// ===========================================================================
+static bool RunDictionary (const char* name, const Options& options, Bench::Json& json)
+{
+	std::string path = Bench::JoinPath (options.dictionaryDir, name);
+
+	WordList list;
+	if (!ReadWords (path, list))
+	{
+		fprintf (stderr, "Cannot read %s\n", path.c_str ());
+		return false;
+	}
+
+	for (int l = 0; l < 2; l ++)
+	{
+		Dictionary::Layout layout = l == 0 ? Dictionary::DENSE : Dictionary::COMPACT;
+		if (layout == Dictionary::DENSE && !options.dense) continue;
+		if (layout == Dictionary::COMPACT && !options.compact) continue;
+
+		fprintf (stderr, "%s, %s layout\n", name, l == 0 ? "dense" : "compact");
+
+		json.BeginObject ();
+		json.Value ("dictionary", name);
+		json.Value ("layout", l == 0 ? "dense" : "compact");
+		RunBuild (list, path, layout, json);
+
+		Dictionary dico (26, list.entrySize, layout);
+		dico.LoadFromFile (path.c_str ());
+		RunQueries (dico, list, options, json);
+		json.Value ("peak_rss_kb", Bench::PeakRssKb ());
+		json.EndObject ();
+	}
+
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Parse the command line
+///
+/// \return	False if the command line is invalid
+// ===========================================================================
+static bool ParseOptions (int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i ++)
+	{
+		const char* arg = argv [i];
+		const char* value = i+1 < argc ? argv [i+1] : nullptr;
+
+		if (value == nullptr) return false;
+		else if (strcmp (arg, "--dict-dir") == 0) options.dictionaryDir = value;
+		else if (strcmp (arg, "--queries") == 0) options.queries = atoi (value);
+		else if (strcmp (arg, "--output") == 0) options.output = value;
+		else if (strcmp (arg, "--layout") == 0)
+		{
+			options.dense = strcmp (value, "dense") == 0 || strcmp (value, "both") == 0;
+			options.compact = strcmp (value, "compact") == 0 || strcmp (value, "both") == 0;
+			if (!options.dense && !options.compact) return false;
+		}
+		else return false;
+		i ++;
+	}
+
+	return options.queries > 0;
+}
+
+
+// ===========================================================================
+/// \brief	Entry point
+// ===========================================================================
+int main (int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions (argc, argv, options))
+	{
+		fprintf (stderr, "Usage: %s [--dict-dir DIR] [--queries N] [--layout dense|compact|both] "
+			"[--output FILE]\n", argv [0]);
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (options.output != nullptr) out = fopen (options.output, "w");
+	if (out == nullptr)
+	{
+		fprintf (stderr, "Cannot open %s\n", options.output);
+		return 1;
+	}
+
+	Bench::Json json (out);
+	json.BeginObject ();
+	json.Value ("benchmark", "dictionary");
+	json.Value ("queries", options.queries);
+	json.Value ("candidate_letters", CANDIDATE_LETTERS);
+	json.BeginArray ("results");
+
+	bool ok = true;
+	for (const char* name : dictionaries) ok &= RunDictionary (name, options, json);
+
+	json.EndArray ();
+	json.EndObject ();
+
+	if (out != stdout) fclose (out);
+	return ok ? 0 : 1;
+}
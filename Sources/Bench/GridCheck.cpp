@@ -0,0 +1,290 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file GridCheck.cpp
+///
+/// \brief	Check of the black box density rules: the bitboards version of
+///			Grid::CheckBlocDensity must agree with the reference one walking the boxes,
+///			for every box and every density mode. Grids are made of every combination
+///			of empty, locked and unlocked black boxes on small sizes, then of random
+///			content (letters, void boxes, black boxes added several times) up to the
+///			largest width. The exit code is not null in case of mismatch.
+///
+/// Usage: wizium_grid_check [--random N] [--seed S]
+// ###########################################################################
+
+#include "Grid/Grid.h"
+#include "Utils/Random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// ===========================================================================
+// D E F I N E
+// ===========================================================================
+
+/// Number of mismatches reported in details
+#define MAX_REPORTS		10
+
+
+
+// ###########################################################################
+//
+// T Y P E S
+//
+// ###########################################################################
+
+/// Box content, for the exhaustive enumeration
+enum BoxState
+{
+	EMPTY,				///< Empty letter box
+	LOCKED_BLOC,		///< Black box given with the grid
+	FREE_BLOC,			///< Black box added by the solver
+	NUM_STATES
+};
+
+/// Check options
+struct Options
+{
+	int random = 20000;
+	uint64_t seed = 1;
+};
+
+/// Check counters
+struct Counters
+{
+	uint64_t checks = 0;
+	uint64_t mismatches = 0;
+};
+
+/// Small grid sizes whose combinations are all checked
+static const uint8_t exhaustiveSizes [][2] = {{3, 3}, {3, 4}, {4, 3}, {2, 5}, {5, 2}};
+
+static const Grid::BlocDensityMode modes [] = {Grid::NONE, Grid::SINGLE, Grid::DIAG, Grid::TWO, Grid::ANY};
+static const char* modeNames [] = {"NONE", "SINGLE", "DIAG", "TWO", "ANY"};
+
+
+
+// ###########################################################################
+//
+// C H E C K S
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Print a grid: '.' empty, 'A' letter, '#' locked black box,
+///			'b' unlocked black box, ' ' void box
+// ===========================================================================
+static void PrintGrid (const Grid& grid)
+{
+	for (int y = 0; y < grid.GetHeight (); y ++)
+	{
+		printf ("  ");
+		for (int x = 0; x < grid.GetWidth (); x ++)
+		{
+			const Box* box = grid (x, y);
+			char c = '.';
+
+			if (box->IsBloc ()) c = box->IsLocked () ? '#' : 'b';
+			else if (box->IsVoid ()) c = ' ';
+			else if (box->GetLetter () != 0) c = 'A';
+			putchar (c);
+		}
+		putchar ('\n');
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Compare both density checks on every box of a grid, for every mode
+///
+/// \param	grid		Grid to check
+/// \param	counters	Counters to update
+// ===========================================================================
+static void CheckGrid (Grid& grid, Counters& counters)
+{
+	for (int m = 0; m < (int) (sizeof (modes) / sizeof (modes [0])); m ++)
+	{
+		grid.SetDensityMode (modes [m]);
+
+		for (int y = 0; y < grid.GetHeight (); y ++)
+		{
+			for (int x = 0; x < grid.GetWidth (); x ++)
+			{
+				bool fast = grid.CheckBlocDensity (x, y);
+				bool reference = grid.CheckBlocDensityBoxes (x, y);
+				counters.checks ++;
+
+				if (fast == reference) continue;
+				if (++ counters.mismatches > MAX_REPORTS) continue;
+
+				printf ("Mismatch at (%d, %d), mode %s: bitboards %d, boxes %d\n", x, y, modeNames [m], fast, reference);
+				PrintGrid (grid);
+			}
+		}
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Check every combination of empty, locked and unlocked black boxes
+///			on a small grid
+///
+/// \param	sx,sy		Grid size
+/// \param	counters	Counters to update
+// ===========================================================================
+static void CheckExhaustive (uint8_t sx, uint8_t sy, Counters& counters)
+{
+	Grid grid;
+	int numBoxes = sx * sy;
+	int numCombinations = 1;
+
+	grid.Grow (sx, sy);
+	for (int i = 0; i < numBoxes; i ++) numCombinations *= NUM_STATES;
+
+	for (int c = 0; c < numCombinations; c ++)
+	{
+		grid.Unlock ();
+		grid.Erase ();
+
+		// Locked black boxes first, then the ones added by a solver
+		for (int pass = 0; pass < 2; pass ++)
+		{
+			int code = c;
+			for (int i = 0; i < numBoxes; i ++, code /= NUM_STATES)
+			{
+				int x = i % sx;
+				int y = i / sx;
+
+				if (pass == 0 && code % NUM_STATES == LOCKED_BLOC) grid (x, y)->MakeBloc ();
+				if (pass == 1 && code % NUM_STATES == FREE_BLOC) grid.AddBloc (x, y);
+			}
+			if (pass == 0) grid.LockContent ();
+		}
+
+		CheckGrid (grid, counters);
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Check a grid of random size and content
+///
+/// \param	rng			Random generator
+/// \param	counters	Counters to update
+// ===========================================================================
+static void CheckRandom (Random& rng, Counters& counters)
+{
+	Grid grid;
+	uint8_t sx = static_cast<uint8_t> (1 + rng.Below (255));
+	uint8_t sy = static_cast<uint8_t> (1 + rng.Below (12));
+
+	// Black boxes density, so that sparse and crowded grids are both checked
+	uint32_t density = 1 + rng.Below (60);
+
+	grid.Grow (sx, sy);
+
+	// Content given with the grid
+	for (int y = 0; y < sy; y ++)
+	{
+		for (int x = 0; x < sx; x ++)
+		{
+			uint32_t r = rng.Below (100);
+
+			if (r < density / 2) grid (x, y)->MakeBloc ();
+			else if (r < density / 2 + 5) grid (x, y)->MakeVoid ();
+			else if (r < density / 2 + 15) grid (x, y)->SetLetter ('A' + rng.Below (26));
+		}
+	}
+	grid.LockContent ();
+
+	// Black boxes added by a solver, some of them several times
+	for (int y = 0; y < sy; y ++)
+	{
+		for (int x = 0; x < sx; x ++)
+		{
+			if (rng.Below (100) >= density / 2) continue;
+			grid.AddBloc (x, y);
+			if (rng.Below (4) == 0) grid.AddBloc (x, y);
+		}
+	}
+
+	CheckGrid (grid, counters);
+
+	// Part of them removed again
+	for (int y = 0; y < sy; y ++)
+	{
+		for (int x = 0; x < sx; x ++)
+		{
+			if (grid (x, y)->IsBloc () && rng.Below (3) == 0) grid.RemoveBloc (x, y);
+		}
+	}
+
+	CheckGrid (grid, counters);
+}
+
+
+// ===========================================================================
+/// \brief	Parse the command line
+// ===========================================================================
+static bool ParseOptions (int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i ++)
+	{
+		const char* arg = argv [i];
+		const char* value = i+1 < argc ? argv [i+1] : nullptr;
+
+		if (value == nullptr) return false;
+		else if (strcmp (arg, "--random") == 0) options.random = atoi (value);
+		else if (strcmp (arg, "--seed") == 0) options.seed = strtoull (value, nullptr, 10);
+		else return false;
+		i ++;
+	}
+
+	return options.random >= 0;
+}
+
+
+// ===========================================================================
+/// \brief	Entry point
+// ===========================================================================
+int main (int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions (argc, argv, options))
+	{
+		fprintf (stderr, "Usage: %s [--random N] [--seed S]\n", argv [0]);
+		return 1;
+	}
+
+	Counters counters;
+
+	for (const auto& size : exhaustiveSizes)
+	{
+		CheckExhaustive (size [0], size [1], counters);
+		printf ("All combinations %dx%d: %llu checks\n", size [0], size [1], (unsigned long long) counters.checks);
+	}
+
+	Random rng (options.seed);
+	for (int i = 0; i < options.random; i ++) CheckRandom (rng, counters);
+	printf ("Random grids: %d\n", options.random);
+
+	printf ("%llu checks, %llu mismatches\n", (unsigned long long) counters.checks, (unsigned long long) counters.mismatches);
+	return counters.mismatches == 0 ? 0 : 1;
+}
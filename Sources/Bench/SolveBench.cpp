@@ -0,0 +1,426 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file SolveBench.cpp
+///
+/// \brief	End-to-end benchmark: solve a fixed corpus of grids with fixed seeds,
+///			for each shipped dictionary, and report the figures as JSON.
+///
+/// Usage: wizium_bench [--dict-dir DIR] [--seeds N] [--timeout-ms MS] [--threads N]
+///						[--slot-order static|fail-first] [--propagation none|arc] [--nogoods N]
+///						[--filter TEXT] [--output FILE]
+// ###########################################################################
+
+#include "libWizium.h"
+#include "Bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIZIUM_DICTIONARY_DIR
+#define WIZIUM_DICTIONARY_DIR "../Dictionaries"
+#endif
+
+
+// ###########################################################################
+//
+// T Y P E S
+//
+// ###########################################################################
+
+/// One grid of the corpus, with the solver configuration to use
+struct BenchCase
+{
+	const char* name;				///< Case name, as reported
+	uint8_t width, height;			///< Grid size
+	int32_t maxBlackBoxes;			///< 0: static solver, otherwise dynamic solver
+	int32_t heuristicLevel;			///< Solver heuristic level
+	void (*setup) (LibHandle);		///< Skeleton and imposed words, applied on the erased grid
+};
+
+/// Benchmark options
+struct Options
+{
+	std::string dictionaryDir = WIZIUM_DICTIONARY_DIR;
+	int seeds = 5;
+	int timeoutMs = 5000;
+	int threads = 1;
+	SlotOrder slotOrder = STATIC_ORDER;
+	Propagation propagation = NO_PROPAGATION;
+	int noGoods = 0;
+	const char* filter = nullptr;
+	const char* output = nullptr;
+};
+
+
+// ###########################################################################
+//
+// C O R P U S
+//
+// ###########################################################################
+
+static void Write (LibHandle h, uint8_t x, uint8_t y, const char* word, char dir, bool terminator)
+{
+	GRID_Write (h, x, y, reinterpret_cast<const uint8_t*> (word), dir, terminator);
+}
+
+// Same black boxes as set_grid_1 in testWizium.py
+static void Pattern11 (LibHandle h)
+{
+	const uint8_t tx [] = {0, 2, 3};
+
+	GRID_SetBox (h, 5, 5, BLACK);
+	for (int i = 0; i < 3; i ++)
+	{
+		GRID_SetBox (h, tx [i], 5-tx [i], BLACK);
+		GRID_SetBox (h, 5+tx [i], tx [i], BLACK);
+		GRID_SetBox (h, 10-tx [i], 5+tx [i], BLACK);
+		GRID_SetBox (h, 5-tx [i], 10-tx [i], BLACK);
+	}
+	GRID_SetBox (h, 5, 1, BLACK);
+	GRID_SetBox (h, 5, 9, BLACK);
+}
+
+// A symmetric 13x13 skeleton with two black boxes per line and column
+static void Pattern13 (LibHandle h)
+{
+	const uint8_t pos [13][2] = {
+		{3, 9}, {6, 12}, {0, 8}, {4, 10}, {2, 7}, {5, 11}, {1, 11},
+		{1, 7}, {5, 10}, {2, 8}, {4, 12}, {0, 6}, {3, 9}};
+
+	for (int y = 0; y < 13; y ++)
+	{
+		GRID_SetBox (h, pos [y][0], y, BLACK);
+		GRID_SetBox (h, pos [y][1], y, BLACK);
+	}
+}
+
+// The set_grid_1 pattern, with imposed words
+static void Words11 (LibHandle h)
+{
+	Pattern11 (h);
+	Write (h, 6, 0, "CHEFS", 'H', false);
+	Write (h, 0, 6, "JACASSEMENT", 'H', false);
+	Write (h, 0, 0, "LOOCH", 'V', false);
+}
+
+static void Empty (LibHandle) {}
+
+// Same as set_grid_2 in testWizium.py: a hole at the center and imposed words
+static void Words17x15 (LibHandle h)
+{
+	for (int i = 0; i < 5; i ++)
+		for (int j = 0; j < 5; j ++)
+			GRID_SetBox (h, 6+i, 5+j, VOID);
+
+	Write (h, 0, 0, "CONSTRAINT", 'H', true);
+	Write (h, 16, 5, "CONSTRAINT", 'V', true);
+	GRID_SetBox (h, 16, 4, BLACK);
+}
+
+// A void block at the center, crossed by the slots of the static solver
+static void Void9 (LibHandle h)
+{
+	for (int i = 0; i < 3; i ++)
+		for (int j = 0; j < 3; j ++)
+			GRID_SetBox (h, 3+i, 3+j, VOID);
+}
+
+// Crossing words imposed on an empty grid
+static void Words15 (LibHandle h)
+{
+	Write (h, 0, 7, "GRILLE", 'H', true);
+	Write (h, 7, 0, "MOTS", 'V', true);
+	Write (h, 9, 14, "CROISE", 'H', false);
+}
+
+static const BenchCase corpus [] =
+{
+	{"empty_11x11",				11, 11, 24, 2, Empty},
+	{"empty_15x15",				15, 15, 45, 2, Empty},
+	{"empty_21x21",				21, 21, 90, 2, Empty},
+	{"pattern_11x11_static",	11, 11, 0, 2, Pattern11},
+	{"pattern_13x13_static",	13, 13, 0, 2, Pattern13},
+	{"words_11x11_static",		11, 11, 0, 2, Words11},
+	{"void_9x9_static",			9, 9, 0, 2, Void9},
+	{"pattern_11x11_dynamic",	11, 11, 6, 2, Pattern11},
+	{"words_17x15",				17, 15, 30, 2, Words17x15},
+	{"words_15x15",				15, 15, 45, 2, Words15},
+};
+
+static const char* dictionaries [] = {"Fr_ODS4.txt", "Fr_Simple.txt"};
+
+
+// ###########################################################################
+//
+// B E N C H M A R K
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Solve one grid of the corpus with every seed and report the figures
+///
+/// \param	h			Instance to use
+/// \param	bench		Grid to solve
+/// \param	options		Benchmark options
+/// \param	json		Report
+// ===========================================================================
+static void RunCase (LibHandle h, const BenchCase& bench, const Options& options, Bench::Json& json)
+{
+	Bench::Samples solveTimes;
+	int solved = 0, exhausted = 0, timeouts = 0;
+	uint64_t steps = 0;
+	double totalMs = 0;
+	SolverStats total = {};
+
+	for (int seed = 1; seed <= options.seeds; seed ++)
+	{
+		GRID_SetSize (h, bench.width, bench.height);
+		GRID_Erase (h);
+		bench.setup (h);
+
+		SolverConfig config;
+		config.seed = seed;
+		config.maxBlackBoxes = bench.maxBlackBoxes;
+		config.heuristicLevel = bench.heuristicLevel;
+		config.blackMode = DIAGONAL;
+		config.numThreads = options.threads;
+		config.slotOrder = options.slotOrder;
+		config.propagation = options.propagation;
+		config.maxNoGoods = options.noGoods;
+
+		Status status;
+		Bench::Timer timer;
+		SOLVER_Start (h, config);
+
+		// Step until the grid is complete, the search space exhausted or the time over
+		double elapsed;
+		do
+		{
+			int32_t remaining = options.timeoutMs - (int32_t) timer.ElapsedMs ();
+			SOLVER_Step (h, remaining > 1 ? remaining : 1, -1, status);
+			elapsed = timer.ElapsedMs ();
+		}
+		while (status.fillRate != 100 && status.fillRate != 0 && elapsed < options.timeoutMs);
+
+		SolverStats stats;
+		SOLVER_GetStats (h, stats);
+		SOLVER_Stop (h);
+
+		if (status.fillRate == 100) { solved ++; solveTimes.Add (elapsed); }
+		else if (status.fillRate == 0) exhausted ++;
+		else timeouts ++;
+
+		steps += status.counter;
+		totalMs += elapsed;
+		total.fillSearches += stats.fillSearches;
+		total.crossChecks += stats.crossChecks;
+		total.cacheHits += stats.cacheHits;
+		total.cacheMisses += stats.cacheMisses;
+		total.backtracks += stats.backtracks;
+		total.wipeouts += stats.wipeouts;
+		total.noGoods += stats.noGoods;
+		total.noGoodRejections += stats.noGoodRejections;
+
+		fprintf (stderr, "  %-24s seed %2d: %s %8.1f ms, %llu steps\n", bench.name, seed,
+			status.fillRate == 100 ? "solved " : status.fillRate == 0 ? "failed " : "timeout",
+			elapsed, (unsigned long long) status.counter);
+	}
+
+	int runs = options.seeds;
+
+	json.BeginObject ();
+	json.Value ("name", bench.name);
+	json.Value ("solver", bench.maxBlackBoxes == 0 ? "static" : "dynamic");
+	json.Value ("width", (int) bench.width);
+	json.Value ("height", (int) bench.height);
+	json.Value ("max_black_boxes", bench.maxBlackBoxes);
+	json.Value ("heuristic_level", bench.heuristicLevel);
+	json.Value ("runs", runs);
+	json.Value ("solved", solved);
+	json.Value ("exhausted", exhausted);
+	json.Value ("timeouts", timeouts);
+	json.Value ("failure_rate", runs > 0 ? (double) (runs - solved) / runs : 0.0);
+	json.Value ("steps", steps);
+	json.Value ("steps_per_sec", totalMs > 0 ? steps * 1000.0 / totalMs : 0.0);
+	json.Value ("total_time_ms", totalMs);
+	json.BeginObject ("solve_time_ms");
+	json.Value ("p50", solveTimes.Percentile (50));
+	json.Value ("p90", solveTimes.Percentile (90));
+	json.Value ("p99", solveTimes.Percentile (99));
+	json.Value ("max", solveTimes.Percentile (100));
+	json.Value ("mean", solveTimes.Mean ());
+	json.EndObject ();
+	json.Value ("fill_searches", total.fillSearches);
+	json.Value ("cross_checks", total.crossChecks);
+	json.Value ("cache_hits", total.cacheHits);
+	json.Value ("cache_misses", total.cacheMisses);
+	json.Value ("backtracks", total.backtracks);
+	json.Value ("wipeouts", total.wipeouts);
+	json.Value ("nogoods", total.noGoods);
+	json.Value ("nogood_rejections", total.noGoodRejections);
+	json.Value ("peak_rss_kb", Bench::PeakRssKb ());
+	json.EndObject ();
+}
+
+
+// ===========================================================================
+/// \brief	Load a dictionary and run the whole corpus with it
+///
+/// \param	name		Dictionary file name
+/// \param	options		Benchmark options
+/// \param	json		Report
+///
+/// \return	False if the dictionary could not be loaded
+// ===========================================================================
+static bool RunDictionary (const char* name, const Options& options, Bench::Json& json)
+{
+	Config config;
+	config.alphabetSize = 0;
+	config.maxWordLength = 21;
+	config.dictionaryLayout = DENSE;
+
+	std::string path = Bench::JoinPath (options.dictionaryDir, name);
+	LibHandle dictionary = DIC_Create (config);
+
+	Bench::Timer timer;
+	int32_t numRejected;
+	int32_t numWords = DIC_LoadFile (dictionary, path.c_str (), numRejected);
+	double loadMs = timer.ElapsedMs ();
+
+	if (numWords <= 0)
+	{
+		fprintf (stderr, "Cannot load %s\n", path.c_str ());
+		DIC_Destroy (dictionary);
+		return false;
+	}
+	fprintf (stderr, "%s: %d words in %.1f ms\n", name, numWords, loadMs);
+
+	LibHandle h = WIZ_CreateInstanceWithDictionary (config, dictionary);
+
+	json.BeginObject ();
+	json.Value ("dictionary", name);
+	json.Value ("words", numWords);
+	json.Value ("rejected", numRejected);
+	json.Value ("load_time_ms", loadMs);
+	json.BeginArray ("cases");
+
+	for (const BenchCase& bench : corpus)
+	{
+		if (options.filter != nullptr && strstr (bench.name, options.filter) == nullptr) continue;
+		RunCase (h, bench, options, json);
+	}
+
+	json.EndArray ();
+	json.EndObject ();
+
+	WIZ_DestroyInstance (h);
+	DIC_Destroy (dictionary);
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Parse the command line
+///
+/// \return	False if the command line is invalid
+// ===========================================================================
+static bool ParseOptions (int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i ++)
+	{
+		const char* arg = argv [i];
+		const char* value = i+1 < argc ? argv [i+1] : nullptr;
+
+		if (value == nullptr) return false;
+		else if (strcmp (arg, "--dict-dir") == 0) options.dictionaryDir = value;
+		else if (strcmp (arg, "--seeds") == 0) options.seeds = atoi (value);
+		else if (strcmp (arg, "--timeout-ms") == 0) options.timeoutMs = atoi (value);
+		else if (strcmp (arg, "--threads") == 0) options.threads = atoi (value);
+		else if (strcmp (arg, "--filter") == 0) options.filter = value;
+		else if (strcmp (arg, "--slot-order") == 0)
+		{
+			if (strcmp (value, "static") == 0) options.slotOrder = STATIC_ORDER;
+			else if (strcmp (value, "fail-first") == 0) options.slotOrder = FAIL_FIRST;
+			else return false;
+		}
+		else if (strcmp (arg, "--propagation") == 0)
+		{
+			if (strcmp (value, "none") == 0) options.propagation = NO_PROPAGATION;
+			else if (strcmp (value, "arc") == 0) options.propagation = ARC_CONSISTENCY;
+			else return false;
+		}
+		else if (strcmp (arg, "--nogoods") == 0) options.noGoods = atoi (value);
+		else if (strcmp (arg, "--output") == 0) options.output = value;
+		else return false;
+		i ++;
+	}
+
+	return options.seeds > 0 && options.timeoutMs > 0;
+}
+
+
+// ===========================================================================
+/// \brief	Entry point
+// ===========================================================================
+int main (int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions (argc, argv, options))
+	{
+		fprintf (stderr, "Usage: %s [--dict-dir DIR] [--seeds N] [--timeout-ms MS] [--threads N] "
+			"[--slot-order static|fail-first] [--propagation none|arc] [--nogoods N] [--filter TEXT] [--output FILE]\n", argv [0]);
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (options.output != nullptr) out = fopen (options.output, "w");
+	if (out == nullptr)
+	{
+		fprintf (stderr, "Cannot open %s\n", options.output);
+		return 1;
+	}
+
+	Version version;
+	WIZ_Init (version);
+
+	char versionText [32];
+	snprintf (versionText, sizeof (versionText), "%d.%d.%d", version.major, version.minor, version.release);
+
+	Bench::Json json (out);
+	json.BeginObject ();
+	json.Value ("benchmark", "solve");
+	json.Value ("version", versionText);
+	json.Value ("seeds", options.seeds);
+	json.Value ("timeout_ms", options.timeoutMs);
+	json.Value ("threads", options.threads);
+	json.Value ("slot_order", options.slotOrder == FAIL_FIRST ? "fail-first" : "static");
+	json.Value ("propagation", options.propagation == ARC_CONSISTENCY ? "arc" : "none");
+	json.Value ("nogoods", options.noGoods);
+	json.BeginArray ("results");
+
+	bool ok = true;
+	for (const char* name : dictionaries) ok &= RunDictionary (name, options, json);
+
+	json.EndArray ();
+	json.Value ("peak_rss_kb", Bench::PeakRssKb ());
+	json.EndObject ();
+
+	if (out != stdout) fclose (out);
+	return ok ? 0 : 1;
+}
@@ -23,9 +23,14 @@
 
 #include "libWizium.h"
 #include "Dictionary.h"
+#include "MappedFile.h"
+#include "Utils/Random.h"
+#include "Utils/Bits.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <atomic>
 
 
 // ===========================================================================
@@ -34,17 +39,67 @@
 
 #define WILDCARD		255
 
+/// Number of words sorted together before insertion, when loading a file
+#define LOAD_BATCH_SIZE		65536
+
+/// Size of a word in a loading batch (null terminated)
+#define LOAD_ENTRY_SIZE		(MAX_WORD_LENGTH + 1)
+
+/// Dictionary image format version. To increment each time the format, or the pools content, change.
+#define IMAGE_VERSION		1
+
+/// Value written in the image header to detect an endianness mismatch
+#define IMAGE_ENDIANNESS	0x01020304
+
+
+/// Last revision stamp given to a dictionary content
+static std::atomic<uint64_t> s_lastRevision (0);
+
+
+// ===========================================================================
+/// \brief	Order two null terminated words of a loading batch: 
+///			by length first, then alphabetically
+// ===========================================================================
+static int CompareBatchEntries (const void* p1, const void* p2)
+{
+	const uint8_t* word1 = static_cast<const uint8_t*> (p1);
+	const uint8_t* word2 = static_cast<const uint8_t*> (p2);
+
+	size_t len1 = strlen (reinterpret_cast<const char*> (word1));
+	size_t len2 = strlen (reinterpret_cast<const char*> (word2));
+
+	if (len1 != len2) return len1 < len2 ? -1 : 1;
+	return memcmp (word1, word2, len1);
+}
+
 
 // ===========================================================================
 // T Y P E S
 // ===========================================================================
 
-/// Trie (Prefix tree) node. Each node represents a letter and has x letters 
-/// possible pointers to the next letter of a word. (x is configurable)
-struct S_WordNode
+/// Number of ints at the begining of a DENSE node, used to store its children mask 
+/// and its summary index (In the DENSE layout, a node is simply an array of indices, one per letter)
+constexpr int DENSE_HEADER = 3;
+
+/// Position of the summary index in the header of a DENSE node
+constexpr int DENSE_SUMMARY = 2;
+
+/// The COMPACT links pool is rebuilt once the holes left by the insertions
+/// exceed 1/COMPACT_LOST_RATIO of it
+constexpr int COMPACT_LOST_RATIO = 4;
+
+/// Summaries are built again once those replaced by the insertions
+/// exceed 1/SUMMARY_LOST_RATIO of their pool
+constexpr int SUMMARY_LOST_RATIO = 4;
+
+/// Trie (Prefix tree) node, COMPACT layout. Each bit of 'children' tells if the
+/// corresponding letter leads to a sub node (or leaf). The indices of those sub nodes
+/// are packed in the links pool, starting at 'first', in the letters order.
+struct S_CompactNode
 {
-	S_WordNode () = delete;
-	int& operator [] (int index) { return *(reinterpret_cast<int*> (this) + index); }
+	uint64_t children;		///< One bit per existing child, same layout as LetterCandidates::flags
+	int first;				///< Index of the first child link in the links pool
+	int summary;			///< Index of the node summary in the summaries pool, -1 if none
 };
 
 /// Last node in the trie (leaf). Characteristics of the words are stored here
@@ -54,6 +109,131 @@ struct S_WordLeaf
 	int idxDeffinition;
 };
 
+/// Header of a dictionary image file. The pools follow, each one starting
+/// at its offset (from the file begining, 64 bits aligned)
+struct S_ImageHeader
+{
+	char magic [4];					///< "WZDI"
+	uint32_t version;				///< IMAGE_VERSION
+	uint32_t endianness;			///< IMAGE_ENDIANNESS
+	int32_t alphabetSize;			///< Alphabet size
+	int32_t maxWordSize;			///< Max word size (and number of roots)
+	int32_t layout;					///< Trie nodes memory layout
+	int32_t denseStride;			///< Number of ints of a DENSE node
+	uint32_t numWordNodes;			///< Number of trie nodes
+	uint32_t numCompactLinks;		///< Number of compact links
+	uint32_t numWordLeafs;			///< Number of trie leaves
+	uint32_t numSummaries;			///< Number of summary masks
+	uint32_t reserved;
+	uint64_t offsetNodes;			///< Trie nodes pool position
+	uint64_t offsetLinks;			///< Compact links pool position
+	uint64_t offsetLeafs;			///< Trie leaves pool position
+	uint64_t offsetSummaries;		///< Summaries pool position
+};
+
+/// Pools of an image being checked by CheckImageNode
+struct S_ImageCheck
+{
+	const S_ImageHeader* pHeader;
+	const int* vWordNodes;				///< DENSE nodes pool
+	const S_CompactNode* vCompactNodes;	///< COMPACT nodes pool
+	const int* vCompactLinks;			///< COMPACT links pool
+	uint64_t alphabet;					///< One bit per letter
+	uint32_t numVisited;				///< Number of nodes checked so far
+};
+
+
+static bool CheckImageNode (S_ImageCheck& check, int idxNode, int depth, int len);
+
+// ===========================================================================
+/// \brief	Check a child of an image node: a leaf on the last level, a node elsewhere
+///
+/// \param	check		Image pools
+/// \param	idxChild	Index of the child
+/// \param	depth		Parent node depth
+/// \param	len			Length of the words of the trie
+///
+/// \return	True if the child can be used safely
+// ===========================================================================
+static bool CheckImageChild (S_ImageCheck& check, int idxChild, int depth, int len)
+{
+	if (depth < len - 1) return CheckImageNode (check, idxChild, depth + 1, len);
+	return idxChild >= 0 && (uint32_t) idxChild < check.pHeader->numWordLeafs;
+}
+
+
+// ===========================================================================
+/// \brief	Check that a node of an image, and its whole subtree, only refer
+///			to existing nodes, links, leaves and summaries
+///
+/// \param	check		Image pools
+/// \param	idxNode		Index of the node
+/// \param	depth		Node depth (0 for a root)
+/// \param	len			Length of the words of the trie
+///
+/// \return	True if the subtree can be used safely
+// ===========================================================================
+static bool CheckImageNode (S_ImageCheck& check, int idxNode, int depth, int len)
+{
+	const S_ImageHeader* pHeader = check.pHeader;
+
+	if (idxNode < 0 || (uint32_t) idxNode >= pHeader->numWordNodes) return false;
+
+	// Each node of a trie is reached once. More visits mean shared nodes or cycles
+	if (++ check.numVisited > pHeader->numWordNodes) return false;
+
+	const int* pNode = nullptr;
+	uint64_t children;
+	int summary;
+
+	if (pHeader->layout == DENSE)
+	{
+		pNode = check.vWordNodes + (size_t) idxNode * pHeader->denseStride;
+		memcpy (&children, pNode, sizeof (children));
+		summary = pNode [DENSE_SUMMARY];
+	}
+	else
+	{
+		const S_CompactNode& node = check.vCompactNodes [idxNode];
+		children = node.children;
+		summary = node.summary;
+
+		if (children != 0 && (node.first < 0 || (uint64_t) node.first + PopCount (children) > pHeader->numCompactLinks)) return false;
+	}
+
+	if ((children & ~check.alphabet) != 0) return false;
+
+	// One summary mask per level below the children
+	if (summary < -1 || (summary >= 0 && (uint64_t) summary + (len - depth - 1) > pHeader->numSummaries)) return false;
+
+	// DENSE nodes are read without looking at the children mask, so missing letters must be marked
+	if (pHeader->layout == DENSE)
+	{
+		for (int idxLetter = 0; idxLetter < pHeader->alphabetSize; idxLetter ++)
+		{
+			int idxChild = pNode [DENSE_HEADER + idxLetter];
+
+			if ((children >> idxLetter & 1) == 0)
+			{
+				if (idxChild != -1) return false;
+			}
+			else if (CheckImageChild (check, idxChild, depth, len) == false) return false;
+		}
+	}
+	else
+	{
+		int first = check.vCompactNodes [idxNode].first;
+		int count = PopCount (children);
+
+		for (int rank = 0; rank < count; rank ++)
+		{
+			if (CheckImageChild (check, check.vCompactLinks [first + rank], depth, len) == false) return false;
+		}
+	}
+
+	return true;
+}
+
 
 
 // ###########################################################################
@@ -68,22 +248,35 @@ struct S_WordLeaf
 /// \param		_alphabetSize		Number of symbol in the alphabet.
 ///									Should be 26 for a standard alphabet but other values are possible (not really tested)
 /// \param		_maxWordSize		Length of the longest word to handle
+/// \param		_layout				Memory layout of the trie nodes
 // ===========================================================================
-Dictionary::Dictionary (int _alphabetSize, int _maxWordSize) : alphabetSize (_alphabetSize), maxWordSize (_maxWordSize)
+Dictionary::Dictionary (int _alphabetSize, int _maxWordSize, Layout _layout) : 
+	alphabetSize (_alphabetSize), maxWordSize (_maxWordSize), layout (_layout)
 {
 	// Check configuration
 	if (maxWordSize <= 0 || maxWordSize > MAX_WORD_LENGTH) maxWordSize = MAX_WORD_LENGTH;
 	if (alphabetSize > 64) alphabetSize = 64;
 	if (alphabetSize <= 0) alphabetSize = 26;
 
-	// One root for each possible word length
-	vRootNodes = new S_WordNode* [maxWordSize];
+	// DENSE nodes start with their header and stay 64 bits aligned
+	denseStride = (DENSE_HEADER + alphabetSize + 1) & ~1;
+
 	vWordNodes = nullptr;
+	vCompactNodes = nullptr;
+	vCompactLinks = nullptr;
 	vWordLeafs = nullptr;
+	vSummaries = nullptr;
 	usedWordNodes = 0;
+	usedCompactLinks = 0;
+	lostCompactLinks = 0;
 	usedWordLeafs = 0;
 	numWordLeafs = 0;
+	numCompactLinks = 0;
 	numWordNodes = 0;
+	numSummaries = 0;
+	usedSummaries = 0;
+	lostSummaries = 0;
+	pImage = nullptr;
 
 	// Flush the dictionary
 	Clear ();
@@ -96,7 +289,6 @@ Dictionary::Dictionary (int _alphabetSize, int _maxWordSize) : alphabetSize (_al
 Dictionary::~Dictionary ()
 {
 	Clean ();
-	delete [] vRootNodes;
 }
 
 
@@ -129,8 +321,8 @@ void Dictionary::Clear ()
 	// Free everything
 	Clean ();
 
-	// One root for each possible word length
-	for (int i = 0; i < this->maxWordSize; i ++) vRootNodes [i] = NewWordNode ();
+	// One root for each possible word length. Root of length 'l' has index 'l-1'
+	for (int i = 0; i < this->maxWordSize; i ++) NewWordNode ();
 	
 	// Add all '1 letter' words
 	for (uint8_t i = 1; i <= alphabetSize; i ++ )
@@ -141,6 +333,23 @@ void Dictionary::Clear ()
 }
 
 
+// ===========================================================================
+/// \brief		Return the amount of memory allocated for the dictionary content
+///
+/// \return		Size in bytes
+// ===========================================================================
+size_t Dictionary::GetMemoryUsage () const
+{
+	size_t size = sizeof (S_WordLeaf) * (size_t) numWordLeafs;
+
+	if (layout == DENSE) size += sizeof (int) * (size_t) numWordNodes * denseStride;
+	else size += sizeof (S_CompactNode) * (size_t) numWordNodes + sizeof (int) * (size_t) numCompactLinks;
+	size += sizeof (uint64_t) * (size_t) numSummaries;
+
+	return size;
+}
+
+
 // ===========================================================================
 /// \brief	Find a word randomly in the dictionary, 
 ///			on the basis of a mask and of letter candidates.
@@ -150,11 +359,12 @@ void Dictionary::Clear ()
 /// \param		mask		Mask enabling to force some letters. 
 ///							'*' means any letter (e.g. "*A***I**)
 ///							Word length is given implicitly by the mask length.
+/// \param		rng			Random generator of the caller
 /// \param		candidates	Letter candidates. If not null, must be an array as long as the mask length.
 ///
 /// \return		True if a match has been found
 // ===========================================================================
-bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], const LetterCandidates possibleLetters []) const
+bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], Random& rng, const LetterCandidates possibleLetters []) const
 {
 	int i;
 	int idxSubNode;
@@ -162,10 +372,8 @@ bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], cons
 	uint8_t idxLetter;
 	uint8_t maskEntry [MAX_WORD_LENGTH+1];
 	uint8_t first [MAX_WORD_LENGTH];
-	S_WordNode* tabDepthNodes [MAX_WORD_LENGTH];
-	S_WordNode *pNode;
-	S_WordNode *pSubNode;
-	S_WordLeaf *pLeaf;
+	int tabDepthNodes [MAX_WORD_LENGTH];
+	int idxNode;
 
 	// Sanitize entries
 	if (result == nullptr) return false;
@@ -173,7 +381,7 @@ bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], cons
 	if (maskLen == 0) return false;
 		
 	// Point on the trie root with the right length
-	pNode = vRootNodes [maskLen -1];
+	idxNode = maskLen -1;
 
 	// Reset buffers
 	for (i = 0; i < maskLen; i ++) {
@@ -191,35 +399,45 @@ bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], cons
 		{
 			idxSubNode = -1;
 
-			// The first time, take a letter at randow. After, we just move on.
-			if (first [depth] == 255) idxLetter = rand () % this->alphabetSize;
-			else idxLetter = (result [depth]-1) +1;
+			// Existing letters that are acceptable
+			uint64_t letters = GetChildren (idxNode);
+			if (possibleLetters != nullptr) letters &= possibleLetters [depth].flags;
 
-			// Search for a letter candidate (among the alphabet)
-			for (i = 0; i < this->alphabetSize; i++)
+			// The first time, take a letter at randow and consider the whole alphabet from there.
+			// After, we just move on up to this first try (with alphabet loopback).
+			uint64_t right, left;
+			if (first [depth] == 255) 
 			{
-				// Check for alphabet loopback
-				if (idxLetter >= this->alphabetSize) idxLetter = 0;
+				idxLetter = static_cast<uint8_t> (rng.Below (this->alphabetSize));
+				first [depth] = idxLetter;
 
-				// Check we didn't get our first try
-				if (first [depth] == idxLetter) break;
-
-				// Save first random letter to detect loopback later
-				if (first [depth] == 255) first [depth] = idxLetter;
+				right = letters & ~LowBits (idxLetter);
+				left = letters & LowBits (idxLetter);
+			}
+			else
+			{
+				idxLetter = (result [depth]-1) +1;
+				if (idxLetter >= this->alphabetSize) idxLetter = 0;
 
-				// Find an existing letter
-				if (pNode->operator [] (idxLetter) >= 0)
+				if (idxLetter < first [depth]) 
+				{
+					right = letters & ~LowBits (idxLetter) & LowBits (first [depth]);
+					left = 0;
+				}
+				else if (idxLetter > first [depth]) 
 				{
-					// Check this letter is acceptable
-					if (possibleLetters == nullptr || possibleLetters [depth].Query (idxLetter))
-					{
-						idxSubNode = pNode->operator [] (idxLetter);
-						break;
-					}
+					right = letters & ~LowBits (idxLetter);
+					left = letters & LowBits (first [depth]);
 				}
+				else right = left = 0;
+			}
 
-				// Move on
-				idxLetter ++;
+			// Take the first candidate on the right of the current letter, or after loopback
+			if (right == 0) right = left;
+			if (right != 0)
+			{
+				idxLetter = CountTrailingZeros (right);
+				idxSubNode = GetChild (idxNode, idxLetter);
 			}
 		}
 		// If letter at this level if forced ...
@@ -227,35 +445,27 @@ bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], cons
 		{
 			// We follow the mask and go forward
 			idxLetter = maskEntry [depth] -1;
-			idxSubNode = pNode->operator [] (idxLetter);
-		}
-
-		// 2) Get corresponding next node (or leaf)
-		if (depth < maskLen - 1) {
-			pSubNode = GetWordNode (idxSubNode);
-			pLeaf = nullptr;
-		}
-		else {
-			pLeaf = GetWordLeaf (idxSubNode);
-			pSubNode = nullptr;
+			idxSubNode = GetChild (idxNode, idxLetter);
 		}
 
-		// 3) If next node is valid, write our solution at this depth
-		if (pSubNode != nullptr || pLeaf != nullptr) result [depth] = idxLetter + 1;
+		// 2) If next node (or leaf) is valid, write our solution at this depth
+		if (idxSubNode >= 0) result [depth] = idxLetter + 1;
 		else 
 		{
 			result [depth] = 0;
 			first [depth] = 255;
 		}
 
-		// 4) Follow our subnode (or leaf) ...
-		if (pSubNode != nullptr)
+		// 3) Follow our subnode (or leaf) ...
+		if (idxSubNode >= 0)
 		{
-			tabDepthNodes [depth] = pNode;
-			pNode = pSubNode;
+			if (depth < maskLen - 1)
+			{
+				tabDepthNodes [depth] = idxNode;
+				idxNode = idxSubNode;
+			}
 			depth ++;
 		}
-		else if (pLeaf != nullptr) depth ++;
 
 		// or go backward if there is no corresponding word in the dictionary...
 		else
@@ -270,7 +480,7 @@ bool Dictionary::FindRandomEntry (uint8_t result [], const uint8_t mask [], cons
 				return false;
 			}
 
-			pNode = tabDepthNodes [depth];
+			idxNode = tabDepthNodes [depth];
 		}
 	}
 
@@ -304,16 +514,18 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 	uint8_t idx;
 	uint8_t maskEntry [MAX_WORD_LENGTH];
 	uint8_t startEntry [MAX_WORD_LENGTH];
-	S_WordNode* tabDepthNodes [MAX_WORD_LENGTH];
-	S_WordNode *pNode;
-	S_WordNode *pSubNode;
-	S_WordLeaf *pLeaf;
+	int tabDepthNodes [MAX_WORD_LENGTH];
+	uint64_t allowed [MAX_WORD_LENGTH];
+	int idxNode;
 
 	// Sanitize mask
 	if (result == nullptr) return false;
 	int maskLen = ProcessEntry (mask, maskEntry);
 	if (maskLen == 0) return false;
 
+	// Letters allowed at each depth, and last depth that is actually constrained
+	int lastConstraint = BuildAllowedLetters (allowed, maskEntry, maskLen, possibleLetters);
+
 	// Sanitize and used start suggestion
 	int startLen = 0;
 	memset (startEntry, 0, maskLen);
@@ -321,7 +533,7 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 	memcpy (result, startEntry, maskLen);
 
 	// Point on the trie root with the right length
-	pNode = vRootNodes [maskLen -1];
+	idxNode = maskLen -1;
 
 	// Init matching word with the start word
 	if (startLen > 0) hotStart = true;
@@ -346,20 +558,20 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 				if (hotStart == false) idx ++;
 			}
 
-			// Search for a letter candidate, starting from the previous solution
+			// Existing letters that are acceptable, starting from the previous solution
+			uint64_t letters = GetChildren (idxNode) & ~LowBits (idx);
+			if (possibleLetters != nullptr) letters &= possibleLetters [depth].flags;
+
+			// Take the first one whose subtree can match the remaining constraints
 			idxSubNode = -1;
-			for (idxLetter = idx; idxLetter < this->alphabetSize; idxLetter++)
+			while (letters != 0)
 			{
-				// Find an existing letter
-				if (pNode->operator [] (idxLetter) >= 0)	
-				{
-					// Check this letter is acceptable				
-					if (possibleLetters == nullptr || possibleLetters [depth].Query (idxLetter) )
-					{
-						idxSubNode = pNode->operator [] (idxLetter);
-						break;
-					}
-				}
+				idxLetter = CountTrailingZeros (letters);
+				idxSubNode = GetChild (idxNode, idxLetter);
+				if (depth >= lastConstraint || IsViable (idxSubNode, allowed + depth + 1, lastConstraint - depth)) break;
+
+				idxSubNode = -1;
+				letters &= letters - 1;
 			}
 		}
 		
@@ -371,31 +583,23 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 			// for the following letters. Then we must go backward
 			if (result [depth] != 0 && hotStart == false) idxSubNode = -1;
 
-			// We follow the mask and go forward
+			// We follow the mask and go forward, unless the subtree cannot match the remaining constraints
 			else
 			{
 				idxLetter = maskEntry [depth] -1;
-				idxSubNode = pNode->operator [] (idxLetter);
+				idxSubNode = GetChild (idxNode, idxLetter);
+				if (idxSubNode >= 0 && depth < lastConstraint && !IsViable (idxSubNode, allowed + depth + 1, lastConstraint - depth))
+					idxSubNode = -1;
 			}
 		}
 
-		// 2) Get corresponding next node (or leaf)
-		if (depth < maskLen - 1) {
-			pSubNode = GetWordNode (idxSubNode);
-			pLeaf = nullptr;
-		}
-		else {
-			pLeaf = GetWordLeaf (idxSubNode);
-			pSubNode = nullptr;
-		}
-
-		// 3) If next node is valid, write our solution at this depth
-		if (pSubNode != nullptr || pLeaf != nullptr) 
+		// 2) If next node (or leaf) is valid, write our solution at this depth
+		if (idxSubNode >= 0) 
 			result [depth] = idxLetter + 1;
 		else result [depth] = 0;
 	
 
-		// 4) If we had to follow 'start' up to there and that we didn't, it means
+		// 3) If we had to follow 'start' up to there and that we didn't, it means
 		// one letter was forbidden. -> we stop following 'start'
 		if (hotStart == true)
 		{
@@ -407,22 +611,20 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 
 				// Force to go back if 'mask' is before 'start' letter
 				if (result [depth] > 0 && startEntry [depth] > 0 && result [depth] < startEntry [depth])
-				{
-					pSubNode = nullptr;
-					pLeaf = nullptr;
-				}
-
+					idxSubNode = -1;
 			}
 		}
 		
-		// 5) Follow our subnode (or leaf) ...
-		if (pSubNode != nullptr)
+		// 4) Follow our subnode (or leaf) ...
+		if (idxSubNode >= 0)
 		{
-			tabDepthNodes [depth] = pNode;
-			pNode = pSubNode;
+			if (depth < maskLen - 1)
+			{
+				tabDepthNodes [depth] = idxNode;
+				idxNode = idxSubNode;
+			}
 			depth ++;
 		}
-		else if (pLeaf != nullptr) depth ++;
 
 		// ... or go backward if there is no corresponding word in the dictionary...
 		else
@@ -434,7 +636,7 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 				return false;
 			}
 
-			pNode = tabDepthNodes [depth];
+			idxNode = tabDepthNodes [depth];
 		}
 	}
 
@@ -443,6 +645,182 @@ bool Dictionary::FindEntry (uint8_t result [], const uint8_t mask [], const uint
 }
 
 
+// ===========================================================================
+/// \brief	Tell if at least one word matches a mask and letter candidates.
+///
+/// Same as FindEntry, without the need to build the matching word.
+///
+/// \param		mask		Mask enabling to force some letters. 
+///							'*' means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+/// \param		candidates	Letter candidates. If not null, must be an array as long as the mask length.
+///
+/// \return		True if a match exists
+// ===========================================================================
+bool Dictionary::Exists (const uint8_t mask [], const LetterCandidates possibleLetters []) const
+{
+	return CountMatches (mask, possibleLetters, 1) > 0;
+}
+
+
+// ===========================================================================
+/// \brief	Count the words matching a mask and letter candidates.
+///
+/// \param		mask		Mask enabling to force some letters. 
+///							'*' means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+/// \param		candidates	Letter candidates. If not null, must be an array as long as the mask length.
+/// \param		limit		If > 0, counting stops as soon as this number of matches is reached
+///
+/// \return		Number of matching words (at most 'limit', if given)
+// ===========================================================================
+int32_t Dictionary::CountMatches (const uint8_t mask [], const LetterCandidates possibleLetters [], int32_t limit) const
+{
+	uint8_t maskEntry [MAX_WORD_LENGTH];
+	uint64_t allowed [MAX_WORD_LENGTH];
+	uint64_t letters [MAX_WORD_LENGTH];
+	int tabDepthNodes [MAX_WORD_LENGTH];
+	int32_t count = 0;
+
+	// Sanitize mask
+	if (mask == nullptr) return 0;
+	int maskLen = ProcessEntry (mask, maskEntry);
+	if (maskLen == 0) return 0;
+
+	// Letters allowed at each depth, and last depth that is actually constrained
+	int lastConstraint = BuildAllowedLetters (allowed, maskEntry, maskLen, possibleLetters);
+
+	// Start from the trie root with the right length
+	int depth = 0;
+	tabDepthNodes [0] = maskLen -1;
+	letters [0] = GetChildren (tabDepthNodes [0]) & allowed [0];
+
+	// Depth first walk, each level keeping the letters that remain to be visited
+	while (depth >= 0)
+	{
+		// On the last level, every remaining letter leads to a leaf, hence to a word
+		if (depth == maskLen -1)
+		{
+			count += PopCount (letters [depth]);
+			if (limit > 0 && count >= limit) return limit;
+
+			depth --;
+			continue;
+		}
+
+		// Nothing more to visit at this level, go backward
+		if (letters [depth] == 0)
+		{
+			depth --;
+			continue;
+		}
+
+		// Take the next letter
+		int idxLetter = CountTrailingZeros (letters [depth]);
+		letters [depth] &= letters [depth] - 1;
+		int idxSubNode = GetChild (tabDepthNodes [depth], idxLetter);
+
+		// Skip the subtrees that cannot match the remaining constraints
+		if (depth < lastConstraint && !IsViable (idxSubNode, allowed + depth + 1, lastConstraint - depth)) continue;
+
+		// Go forward
+		depth ++;
+		tabDepthNodes [depth] = idxSubNode;
+		letters [depth] = GetChildren (idxSubNode) & allowed [depth];
+	}
+
+	return count;
+}
+
+
+// ===========================================================================
+/// \brief	Find the letters that appear at a given position of the words
+///			matching a mask and letter candidates.
+///
+/// A single trie walk answers what would otherwise take one existence check per letter:
+/// as soon as a word is found for a letter, the walk goes back to try the next one.
+///
+/// \param		mask		Mask enabling to force some letters. 
+///							'*' means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+/// \param		pos			Position of the letters to collect, in the mask
+/// \param		candidates	Letter candidates. If not null, must be an array as long as the mask length.
+///
+/// \return		One bit per letter found at 'pos', same layout as LetterCandidates::flags
+// ===========================================================================
+uint64_t Dictionary::MatchingLetters (const uint8_t mask [], int pos, const LetterCandidates possibleLetters []) const
+{
+	uint8_t maskEntry [MAX_WORD_LENGTH];
+	uint64_t allowed [MAX_WORD_LENGTH];
+	uint64_t letters [MAX_WORD_LENGTH];
+	int tabDepthNodes [MAX_WORD_LENGTH];
+	uint64_t found = 0;
+	int letterAtPos = 0;
+
+	// Sanitize mask
+	if (mask == nullptr) return 0;
+	int maskLen = ProcessEntry (mask, maskEntry);
+	if (pos < 0 || pos >= maskLen) return 0;
+
+	// Letters allowed at each depth, and last depth that is actually constrained
+	int lastConstraint = BuildAllowedLetters (allowed, maskEntry, maskLen, possibleLetters);
+
+	// Start from the trie root with the right length
+	int depth = 0;
+	tabDepthNodes [0] = maskLen -1;
+	letters [0] = GetChildren (tabDepthNodes [0]) & allowed [0];
+
+	// Depth first walk, each level keeping the letters that remain to be visited
+	while (depth >= 0)
+	{
+		// Letters already found need no other word
+		if (depth == pos) letters [depth] &= ~found;
+
+		// Past the target position and the last constraint, every remaining letter leads to a matching word
+		if (depth >= pos && depth >= lastConstraint)
+		{
+			if (letters [depth] == 0) depth --;
+			else if (depth == pos)
+			{
+				found |= letters [depth];
+				depth --;
+			}
+			else
+			{
+				found |= 1ULL << letterAtPos;
+				depth = pos;
+			}
+
+			if (found == allowed [pos]) break;
+			continue;
+		}
+
+		// Nothing more to visit at this level, go backward
+		if (letters [depth] == 0)
+		{
+			depth --;
+			continue;
+		}
+
+		// Take the next letter
+		int idxLetter = CountTrailingZeros (letters [depth]);
+		letters [depth] &= letters [depth] - 1;
+		int idxSubNode = GetChild (tabDepthNodes [depth], idxLetter);
+
+		// Skip the subtrees that cannot match the remaining constraints
+		if (depth < lastConstraint && !IsViable (idxSubNode, allowed + depth + 1, lastConstraint - depth)) continue;
+
+		// Go forward
+		if (depth == pos) letterAtPos = idxLetter;
+		depth ++;
+		tabDepthNodes [depth] = idxSubNode;
+		letters [depth] = GetChildren (idxSubNode) & allowed [depth];
+	}
+
+	return found;
+}
+
+
 // ===========================================================================
 /// \brief	Add a word list in the dictionary
 ///
@@ -462,6 +840,9 @@ int32_t Dictionary::AddEntries (const uint8_t* tabEntries, int32_t entrySize, in
 	int idx;
 	int count = 0;
 
+	// Pools must be writable
+	Detach ();
+
 	// Loop on word list
 	while (true)
 	{
@@ -512,68 +893,579 @@ int32_t Dictionary::AddEntries (const uint8_t* tabEntries, int32_t entrySize, in
 		if (count >= numWords && numWords >= 0) break;
 	}
 
+	// Get rid of the holes left in the links pool by the insertions, once they are worth it
+	if (layout == COMPACT) Compact ();
+
+	// Summaries must reflect the new content of the trie. Once built, they follow each
+	// insertion and are only built again when too many of them have been replaced
+	if (vSummaries == nullptr || (uint64_t) lostSummaries * SUMMARY_LOST_RATIO > usedSummaries) BuildSummaries ();
+
 	return count;
 }
 
 
 
-// ###########################################################################
-//
-// P R I V A T E
-//
-// ###########################################################################
-
 // ===========================================================================
-/// \brief	Remove everything and clean memory
+/// \brief	Load a whole word list file in the dictionary
+///
+/// The file is mapped in memory and holds one word per line. With the default 
+/// 26 letters alphabet, ASCII letters are accepted whatever their case. Otherwise, 
+/// each byte must be in the range [1..alphabetSize]. Blank lines are ignored and 
+/// lines holding anything else, or too long words, are rejected.
+///
+/// Words are inserted by sorted batches, which keeps the related trie nodes close
+/// together in memory.
+///
+/// \param		path			File to load
+/// \param[out]	pNumRejected	Number of lines that have been rejected (can be null)
+///
+/// \return		Number of words added to the dictionary, -1 if the file cannot be read
 // ===========================================================================
-void Dictionary::Clean ()
+int32_t Dictionary::LoadFromFile (const char* path, int32_t* pNumRejected)
 {
-	if (vWordNodes != nullptr) delete [] vWordNodes;
-	if (vWordLeafs != nullptr) delete [] vWordLeafs;
+	MappedFile file;
+	int32_t numAccepted = 0;
+	int32_t numRejected = 0;
+	int numBatch = 0;
 
-	vWordNodes = nullptr;
-	vWordLeafs = nullptr;
-	
-	numWordNodes = 0;
-	numWordLeafs = 0;
+	if (pNumRejected != nullptr) *pNumRejected = 0;
+	if (file.Open (path) == false) return -1;
 
-	usedWordNodes = 0;
-	usedWordLeafs = 0;
-}
+	// Pools must be writable
+	Detach ();
 
+	const uint8_t* pChar = file.GetData ();
+	const uint8_t* pEnd = pChar + file.GetSize ();
 
-// ===========================================================================
-/// \brief	Process a user word entry before further processing.
-///
-/// Its content must be in the range [1..alphabetSize], other values being
-/// considered as wildcard.
-///
-/// \return	Entry length
-// ===========================================================================
-int Dictionary::ProcessEntry (const uint8_t* entry, uint8_t* out) const
-{
-	int idx;
+	// Skip UTF-8 byte order mark
+	if (file.GetSize () >= 3 && pChar [0] == 0xEF && pChar [1] == 0xBB && pChar [2] == 0xBF) pChar += 3;
 
-	for (idx = 0; idx < this->maxWordSize; idx++)
+	uint8_t* batch = new uint8_t [LOAD_BATCH_SIZE * LOAD_ENTRY_SIZE];
+
+	// Loop on lines
+	while (pChar < pEnd)
 	{
-		if (entry [idx] == 0) break;
-		out [idx] = entry [idx];
+		const uint8_t* pLine = pChar;
+		while (pChar < pEnd && *pChar != '\n') pChar ++;
+		const uint8_t* pLineEnd = pChar;
+		if (pChar < pEnd) pChar ++;
+
+		// Trim blanks, including the '\r' of Windows files
+		while (pLine < pLineEnd && (*pLine == ' ' || *pLine == '\t')) pLine ++;
+		while (pLineEnd > pLine && (pLineEnd [-1] == ' ' || pLineEnd [-1] == '\t' || pLineEnd [-1] == '\r')) pLineEnd --;
+		if (pLine == pLineEnd) continue;
+
+		// Check length
+		int len = (int) (pLineEnd - pLine);
+		if (len > maxWordSize)
+		{
+			numRejected ++;
+			continue;
+		}
 
-		if (alphabetSize == 26)
+		// Normalize letters in the range [1..alphabetSize]
+		uint8_t* word = batch + numBatch * LOAD_ENTRY_SIZE;
+		int idx;
+		for (idx = 0; idx < len; idx ++)
 		{
-			if (entry [idx] >= 'A' && entry [idx] <= 'Z') out [idx] += 1 - 'A';
-			if (entry [idx] >= 'a' && entry [idx] <= 'z') out [idx] += 1 - 'a';
+			uint8_t c = pLine [idx];
+
+			if (alphabetSize == 26)
+			{
+				if (c >= 'A' && c <= 'Z') c += 1 - 'A';
+				else if (c >= 'a' && c <= 'z') c += 1 - 'a';
+			}
+			if (c < 1 || c > alphabetSize) break;
+			word [idx] = c;
+		}
+		if (idx < len)
+		{
+			numRejected ++;
+			continue;
+		}
+		word [len] = 0;
+
+		// Insert full batches
+		numBatch ++;
+		if (numBatch == LOAD_BATCH_SIZE)
+		{
+			int32_t count = AddBatch (batch, numBatch);
+			numRejected += numBatch - count;
+			numAccepted += count;
+			numBatch = 0;
 		}
-		if (out [idx] > this->alphabetSize) out [idx] = WILDCARD;
 	}
-	
-	return idx;
+
+	// Last batch
+	int32_t count = AddBatch (batch, numBatch);
+	numRejected += numBatch - count;
+	numAccepted += count;
+
+	delete [] batch;
+
+	// Same finalization as AddEntries
+	if (layout == COMPACT) Compact ();
+	if (vSummaries == nullptr || (uint64_t) lostSummaries * SUMMARY_LOST_RATIO > usedSummaries) BuildSummaries ();
+
+	if (pNumRejected != nullptr) *pNumRejected = numRejected;
+	return numAccepted;
 }
 
 
 
 // ===========================================================================
-/// \brief	Add a single word in the dictionary
+/// \brief	Save the dictionary content in an image file that LoadImage can map
+///
+/// \param		path		File to write
+///
+/// \return		True in case of success
+// ===========================================================================
+bool Dictionary::SaveImage (const char* path) const
+{
+	S_ImageHeader header;
+	const uint8_t padding [8] = {0};
+
+	if (path == nullptr) return false;
+
+	// Pools sizes
+	size_t sizeNodes = layout == DENSE ? 
+		sizeof (int) * (size_t) usedWordNodes * denseStride : 
+		sizeof (S_CompactNode) * (size_t) usedWordNodes;
+	size_t sizeLinks = layout == DENSE ? 0 : sizeof (int) * (size_t) usedCompactLinks;
+	size_t sizeLeafs = sizeof (S_WordLeaf) * (size_t) usedWordLeafs;
+	size_t sizeSummaries = sizeof (uint64_t) * (size_t) usedSummaries;
+
+	// Header
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, "WZDI", 4);
+	header.version = IMAGE_VERSION;
+	header.endianness = IMAGE_ENDIANNESS;
+	header.alphabetSize = alphabetSize;
+	header.maxWordSize = maxWordSize;
+	header.layout = layout;
+	header.denseStride = denseStride;
+	header.numWordNodes = usedWordNodes;
+	header.numCompactLinks = layout == DENSE ? 0 : usedCompactLinks;
+	header.numWordLeafs = usedWordLeafs;
+	header.numSummaries = usedSummaries;
+
+	// Pools positions, 64 bits aligned
+	header.offsetNodes = (sizeof (header) + 7) & ~7ULL;
+	header.offsetLinks = (header.offsetNodes + sizeNodes + 7) & ~7ULL;
+	header.offsetLeafs = (header.offsetLinks + sizeLinks + 7) & ~7ULL;
+	header.offsetSummaries = (header.offsetLeafs + sizeLeafs + 7) & ~7ULL;
+
+	// The image is written aside, then moved over the target. The target may be mapped
+	// by LoadImage, and truncating it would break the dictionaries using it
+	size_t pathLen = strlen (path);
+	char* tmpPath = new char [pathLen + 5];
+	memcpy (tmpPath, path, pathLen);
+	memcpy (tmpPath + pathLen, ".tmp", 5);
+
+	FILE* file = fopen (tmpPath, "wb");
+	if (file == nullptr)
+	{
+		delete [] tmpPath;
+		return false;
+	}
+
+	const void* pools [4] = 
+	{ 
+		layout == DENSE ? static_cast<const void*> (vWordNodes) : static_cast<const void*> (vCompactNodes), 
+		vCompactLinks, vWordLeafs, vSummaries 
+	};
+	size_t sizes [4] = {sizeNodes, sizeLinks, sizeLeafs, sizeSummaries};
+	uint64_t offsets [4] = {header.offsetNodes, header.offsetLinks, header.offsetLeafs, header.offsetSummaries};
+
+	// Write everything
+	bool success = fwrite (&header, sizeof (header), 1, file) == 1;
+	uint64_t pos = sizeof (header);
+
+	for (int i = 0; i < 4 && success; i ++)
+	{
+		if (offsets [i] > pos) success = fwrite (padding, (size_t) (offsets [i] - pos), 1, file) == 1;
+		if (success && sizes [i] > 0) success = fwrite (pools [i], sizes [i], 1, file) == 1;
+		pos = offsets [i] + sizes [i];
+	}
+
+	if (fclose (file) != 0) success = false;
+
+	// Replace the target (rename doesn't overwrite an existing file on Windows)
+#ifdef _WIN32
+	if (success) remove (path);
+#endif
+	if (success && rename (tmpPath, path) != 0) success = false;
+	if (success == false) remove (tmpPath);
+
+	delete [] tmpPath;
+	return success;
+}
+
+
+// ===========================================================================
+/// \brief	Replace the dictionary content by an image saved with SaveImage.
+///
+/// The file is mapped in memory and its pools are used in place, without copy. 
+/// They are copied only if the dictionary is modified afterwards.
+///
+/// \param		path		Image file
+///
+/// \return		True in case of success. False if the file cannot be read, is
+///				not a valid image, or doesn't match the alphabet and max word sizes.
+///				The dictionary is left unchanged in case of failure.
+// ===========================================================================
+bool Dictionary::LoadImage (const char* path)
+{
+	MappedFile* pFile = new MappedFile ();
+	if (pFile->Open (path) == false || pFile->GetSize () < sizeof (S_ImageHeader))
+	{
+		delete pFile;
+		return false;
+	}
+
+	const uint8_t* pData = pFile->GetData ();
+	uint64_t fileSize = pFile->GetSize ();
+	const S_ImageHeader* pHeader = reinterpret_cast<const S_ImageHeader*> (pData);
+
+	// Check the header
+	bool valid = 
+		memcmp (pHeader->magic, "WZDI", 4) == 0 &&
+		pHeader->version == IMAGE_VERSION &&
+		pHeader->endianness == IMAGE_ENDIANNESS &&
+		pHeader->alphabetSize == alphabetSize &&
+		pHeader->maxWordSize == maxWordSize &&
+		(pHeader->layout == DENSE || pHeader->layout == COMPACT) &&
+		pHeader->numWordNodes >= (uint32_t) maxWordSize &&
+		pHeader->numWordLeafs >= (uint32_t) alphabetSize;
+
+	// Check pools positions
+	if (valid)
+	{
+		uint64_t sizeNodes = pHeader->layout == DENSE ? 
+			sizeof (int) * (uint64_t) pHeader->numWordNodes * denseStride : 
+			sizeof (S_CompactNode) * (uint64_t) pHeader->numWordNodes;
+
+		valid = 
+			pHeader->denseStride == denseStride &&
+			pHeader->offsetNodes % 8 == 0 && pHeader->offsetNodes + sizeNodes <= fileSize &&
+			pHeader->offsetLinks % 8 == 0 && pHeader->offsetLinks + sizeof (int) * (uint64_t) pHeader->numCompactLinks <= fileSize &&
+			pHeader->offsetLeafs % 8 == 0 && pHeader->offsetLeafs + sizeof (S_WordLeaf) * (uint64_t) pHeader->numWordLeafs <= fileSize &&
+			pHeader->offsetSummaries % 8 == 0 && pHeader->offsetSummaries + sizeof (uint64_t) * (uint64_t) pHeader->numSummaries <= fileSize;
+	}
+
+	// Check every index found in the pools, from each root, so that queries never read out of them
+	if (valid)
+	{
+		S_ImageCheck check;
+
+		check.pHeader = pHeader;
+		check.vWordNodes = reinterpret_cast<const int*> (pData + pHeader->offsetNodes);
+		check.vCompactNodes = reinterpret_cast<const S_CompactNode*> (pData + pHeader->offsetNodes);
+		check.vCompactLinks = reinterpret_cast<const int*> (pData + pHeader->offsetLinks);
+		check.alphabet = LowBits (alphabetSize);
+		check.numVisited = 0;
+
+		for (int len = 1; len <= maxWordSize && valid; len ++)
+		{
+			valid = CheckImageNode (check, len - 1, 0, len);
+		}
+	}
+
+	if (valid == false)
+	{
+		delete pFile;
+		return false;
+	}
+
+	// Drop the current content and use the mapped pools in place
+	Clean ();
+	pImage = pFile;
+	layout = (Layout) pHeader->layout;
+
+	void* pNodes = const_cast<uint8_t*> (pData + pHeader->offsetNodes);
+	if (layout == DENSE) vWordNodes = static_cast<int*> (pNodes);
+	else vCompactNodes = static_cast<S_CompactNode*> (pNodes);
+
+	vCompactLinks = pHeader->numCompactLinks > 0 ? reinterpret_cast<int*> (const_cast<uint8_t*> (pData + pHeader->offsetLinks)) : nullptr;
+	vWordLeafs = reinterpret_cast<S_WordLeaf*> (const_cast<uint8_t*> (pData + pHeader->offsetLeafs));
+	vSummaries = pHeader->numSummaries > 0 ? reinterpret_cast<uint64_t*> (const_cast<uint8_t*> (pData + pHeader->offsetSummaries)) : nullptr;
+
+	numWordNodes = usedWordNodes = pHeader->numWordNodes;
+	numCompactLinks = usedCompactLinks = pHeader->numCompactLinks;
+	numWordLeafs = usedWordLeafs = pHeader->numWordLeafs;
+	numSummaries = usedSummaries = pHeader->numSummaries;
+	lostCompactLinks = 0;
+	lostSummaries = 0;
+
+	return true;
+}
+
+
+
+// ###########################################################################
+//
+// P R I V A T E
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Remove everything and clean memory
+// ===========================================================================
+void Dictionary::Clean ()
+{
+	// Pools mapped from an image are released with it
+	if (pImage != nullptr)
+	{
+		delete pImage;
+		pImage = nullptr;
+	}
+	else
+	{
+		if (vWordNodes != nullptr) delete [] vWordNodes;
+		if (vCompactNodes != nullptr) delete [] vCompactNodes;
+		if (vCompactLinks != nullptr) delete [] vCompactLinks;
+		if (vWordLeafs != nullptr) delete [] vWordLeafs;
+		if (vSummaries != nullptr) delete [] vSummaries;
+	}
+
+	vWordNodes = nullptr;
+	vCompactNodes = nullptr;
+	vCompactLinks = nullptr;
+	vWordLeafs = nullptr;
+	vSummaries = nullptr;
+	revision = ++ s_lastRevision;
+	
+	numWordNodes = 0;
+	numCompactLinks = 0;
+	numWordLeafs = 0;
+	numSummaries = 0;
+
+	usedWordNodes = 0;
+	usedCompactLinks = 0;
+	lostCompactLinks = 0;
+	usedWordLeafs = 0;
+	usedSummaries = 0;
+	lostSummaries = 0;
+}
+
+
+// ===========================================================================
+/// \brief	Copy the pools mapped from an image into allocated memory, 
+///			so that they can be modified.
+// ===========================================================================
+void Dictionary::Detach ()
+{
+	// Content is going to change
+	revision = ++ s_lastRevision;
+
+	if (pImage == nullptr) return;
+
+	int* pWordNodes = nullptr;
+	S_CompactNode* pCompactNodes = nullptr;
+	int* pCompactLinks = nullptr;
+
+	if (layout == DENSE)
+	{
+		pWordNodes = new int [(size_t) numWordNodes * denseStride];
+		memcpy (pWordNodes, vWordNodes, sizeof (int) * numWordNodes * denseStride);
+	}
+	else
+	{
+		pCompactNodes = new S_CompactNode [numWordNodes];
+		memcpy (pCompactNodes, vCompactNodes, sizeof (S_CompactNode) * numWordNodes);
+		pCompactLinks = new int [numCompactLinks];
+		memcpy (pCompactLinks, vCompactLinks, sizeof (int) * numCompactLinks);
+	}
+
+	S_WordLeaf* pWordLeafs = new S_WordLeaf [numWordLeafs];
+	memcpy (pWordLeafs, vWordLeafs, sizeof (S_WordLeaf) * numWordLeafs);
+
+	uint64_t* pSummaries = new uint64_t [numSummaries];
+	memcpy (pSummaries, vSummaries, sizeof (uint64_t) * numSummaries);
+
+	// Release the image, keeping the pools usage
+	delete pImage;
+	pImage = nullptr;
+
+	vWordNodes = pWordNodes;
+	vCompactNodes = pCompactNodes;
+	vCompactLinks = pCompactLinks;
+	vWordLeafs = pWordLeafs;
+	vSummaries = pSummaries;
+}
+
+
+// ===========================================================================
+/// \brief	Rebuild the links pool of the COMPACT layout, in order to remove
+///			the holes left by the nodes that have grown.
+///
+/// Links are packed following the nodes order, which also improves locality.
+/// Rebuilding the whole pool after each small insertion would cost too much, 
+/// so it is only done once enough links are lost.
+// ===========================================================================
+void Dictionary::Compact ()
+{
+	if ((uint64_t) lostCompactLinks * COMPACT_LOST_RATIO <= usedCompactLinks) return;
+
+	unsigned int newSize = usedCompactLinks - lostCompactLinks;
+	int *pNewTab = new int [newSize > 0 ? newSize : 1];
+	unsigned int pos = 0;
+
+	// Copy the links of each node, one after the other
+	for (unsigned int i = 0; i < usedWordNodes; i ++)
+	{
+		S_CompactNode& node = vCompactNodes [i];
+		int count = PopCount (node.children);
+
+		if (count > 0) memcpy (pNewTab + pos, vCompactLinks + node.first, sizeof (int) * count);
+		node.first = pos;
+		pos += count;
+	}
+
+	delete [] vCompactLinks;
+	vCompactLinks = pNewTab;
+	numCompactLinks = newSize > 0 ? newSize : 1;
+	usedCompactLinks = pos;
+	lostCompactLinks = 0;
+}
+
+
+// ===========================================================================
+/// \brief	Build the per-depth letter summaries of all the trie nodes.
+///
+/// The summary of a node located 'r' letters from the end of its word gathers
+/// 'r-1' masks. Mask 'k' (starting at 1) tells which letters occur 'k' levels
+/// below the node children, in any word of its subtree. Identical summaries are
+/// stored only once, which happens a lot close to the leaves.
+// ===========================================================================
+void Dictionary::BuildSummaries ()
+{
+	uint64_t summary [MAX_WORD_LENGTH];
+	unsigned int used = 0;
+
+	if (vSummaries != nullptr) delete [] vSummaries;
+	vSummaries = nullptr;
+	numSummaries = usedSummaries = lostSummaries = 0;
+	if (usedWordNodes == 0) return;
+
+	uint8_t* remaining = new uint8_t [usedWordNodes];
+
+	// Number of letters left from each node. Sub nodes always follow their parent in the pool
+	unsigned int totalSize = 0;
+	for (unsigned int i = 0; i < usedWordNodes; i ++)
+	{
+		if (i < (unsigned int) maxWordSize) remaining [i] = i + 1;
+		if (remaining [i] <= 1) continue;
+
+		totalSize += remaining [i] - 1;
+		for (uint64_t children = GetChildren (i); children != 0; children &= children - 1)
+		{
+			int idxSubNode = GetChild (i, CountTrailingZeros (children));
+			if (idxSubNode >= 0) remaining [idxSubNode] = remaining [i] - 1;
+		}
+	}
+
+	// Hash table to share identical summaries (entries are summary index +1, 0 when empty)
+	unsigned int hashSize = 1024;
+	while (hashSize < 2 * usedWordNodes) hashSize <<= 1;
+	int* hashTable = new int [hashSize];
+	uint8_t* hashLength = new uint8_t [hashSize];
+	memset (hashTable, 0, sizeof (int) * hashSize);
+
+	// Worst case, when nothing can be shared
+	vSummaries = new uint64_t [totalSize > 0 ? totalSize : 1];
+
+	// Bottom-up, sub nodes being processed before their parent
+	for (int i = (int) usedWordNodes -1; i >= 0; i --)
+	{
+		int len = remaining [i] - 1;
+		if (len <= 0) 
+		{
+			SetSummary (i, -1);
+			continue;
+		}
+
+		// Merge the children and summaries of our sub nodes
+		memset (summary, 0, sizeof (uint64_t) * len);
+		for (uint64_t children = GetChildren (i); children != 0; children &= children - 1)
+		{
+			int idxSubNode = GetChild (i, CountTrailingZeros (children));
+			const uint64_t* pSubSummary = GetSummary (idxSubNode);
+
+			summary [0] |= GetChildren (idxSubNode);
+			for (int k = 1; k < len; k ++) summary [k] |= pSubSummary [k-1];
+		}
+
+		// Look for the same summary
+		uint64_t hash = 14695981039346656037ULL;
+		for (int k = 0; k < len; k ++) hash = (hash ^ summary [k]) * 1099511628211ULL;
+
+		unsigned int slot = (unsigned int) (hash ^ (hash >> 32)) & (hashSize -1);
+		while (hashTable [slot] != 0)
+		{
+			int idx = hashTable [slot] -1;
+			if (hashLength [slot] == len && memcmp (vSummaries + idx, summary, sizeof (uint64_t) * len) == 0) break;
+			slot = (slot + 1) & (hashSize -1);
+		}
+
+		// Not found, add it
+		if (hashTable [slot] == 0)
+		{
+			memcpy (vSummaries + used, summary, sizeof (uint64_t) * len);
+			hashTable [slot] = used + 1;
+			hashLength [slot] = len;
+			used += len;
+		}
+
+		SetSummary (i, hashTable [slot] -1);
+	}
+
+	// Shrink the pool to its actual size
+	uint64_t* pNewTab = new uint64_t [used > 0 ? used : 1];
+	memcpy (pNewTab, vSummaries, sizeof (uint64_t) * used);
+	delete [] vSummaries;
+	vSummaries = pNewTab;
+	numSummaries = used > 0 ? used : 1;
+	usedSummaries = used;
+
+	delete [] hashTable;
+	delete [] hashLength;
+	delete [] remaining;
+}
+
+
+// ===========================================================================
+/// \brief	Process a user word entry before further processing.
+///
+/// Its content must be in the range [1..alphabetSize], other values being
+/// considered as wildcard.
+///
+/// \return	Entry length
+// ===========================================================================
+int Dictionary::ProcessEntry (const uint8_t* entry, uint8_t* out) const
+{
+	int idx;
+
+	for (idx = 0; idx < this->maxWordSize; idx++)
+	{
+		if (entry [idx] == 0) break;
+		out [idx] = entry [idx];
+
+		if (alphabetSize == 26)
+		{
+			if (entry [idx] >= 'A' && entry [idx] <= 'Z') out [idx] += 1 - 'A';
+			if (entry [idx] >= 'a' && entry [idx] <= 'z') out [idx] += 1 - 'a';
+		}
+		if (out [idx] > this->alphabetSize) out [idx] = WILDCARD;
+	}
+	
+	return idx;
+}
+
+
+
+// ===========================================================================
+/// \brief	Add a single word in the dictionary
 ///
 /// \param	entry	Null terminated word
 ///
@@ -582,11 +1474,10 @@ int Dictionary::ProcessEntry (const uint8_t* entry, uint8_t* out) const
 bool Dictionary::AddEntry (const uint8_t* entry)
 {
 	int i, len=-1;
-	int idxNode = -1, idxSubNode;
+	int idxNode, idxSubNode;
 	int idxLetter;
+	int path [MAX_WORD_LENGTH];
 
-	S_WordNode *pWordNode;
-	S_WordNode *pSubNode;
 	S_WordLeaf *pWordLeaf;
 
 	while (entry [++len] != 0);
@@ -594,41 +1485,34 @@ bool Dictionary::AddEntry (const uint8_t* entry)
 		return false;
 
 	// Get trie corresponding to the given word length
-	pWordNode = vRootNodes [len-1];
+	idxNode = len-1;
 
 	// Add letters, one by one
 	for (i = 0; i < len-1; i ++)
 	{
 		// Letter index
 		idxLetter = entry [i] -1;
+		path [i] = idxNode;
 
 		// Get sub node for this letter
-		idxSubNode = pWordNode->operator[] (idxLetter);
-		pSubNode = GetWordNode (idxSubNode);
+		idxSubNode = GetChild (idxNode, idxLetter);
 
-		// If sub node not found, create it
-		if (pSubNode == nullptr)
+		// If sub node not found, create it and link it to its parent
+		if (idxSubNode < 0)
 		{
-			// Save node index
-			if (i > 0) idxNode = MakeIndex (pWordNode);
+			idxSubNode = NewWordNode ();
+			if (idxSubNode < 0) return false;
 
-			// Allocate new node (this can invalidate all node pointers)
-			pSubNode = NewWordNode ();
-
-			// Restore node from index
-			if (i > 0) pWordNode = GetWordNode (idxNode);
-
-			// Link to parent
-			pWordNode->operator[] (idxLetter) = MakeIndex (pSubNode);
+			SetChild (idxNode, idxLetter, idxSubNode);
 		}
 
 		// Move on next node
-		pWordNode = pSubNode;
+		idxNode = idxSubNode;
 	}
 
 	// Leave for the final letter
 	idxLetter = entry [i] -1;
-	idxSubNode = pWordNode->operator[] (idxLetter);
+	idxSubNode = GetChild (idxNode, idxLetter);
 
 	pWordLeaf = GetWordLeaf (idxSubNode);
 
@@ -637,59 +1521,271 @@ bool Dictionary::AddEntry (const uint8_t* entry)
 	{
 		// Allocation and link it to its parent node
 		pWordLeaf = NewWordLeaf ();
-		pWordNode->operator[] (idxLetter) = MakeIndex (pWordLeaf);
+		if (pWordLeaf == nullptr) return false;
+		SetChild (idxNode, idxLetter, MakeIndex (pWordLeaf));
 
 		pWordLeaf->idxDeffinition = -1;
 	}
+
+	// Once built, summaries follow the new word
+	if (vSummaries != nullptr) UpdateSummaries (entry, path, len);
 		
 	return true;
 }
 
 
 // ===========================================================================
-/// \brief	Convert a pool index into a Trie node
+/// \brief	Merge the letters of a new word in the summaries of the nodes on its path
 ///
-/// \param	idx		Index to convert
+/// Summaries are shared between nodes, so a summary that changes is replaced by
+/// a new one at the end of the pool. The former one is counted as lost.
 ///
-/// \return	Trie node. Null if index out of bounds.
+/// \param	entry	Word, letters in the range [1..alphabetSize]
+/// \param	path	Nodes of the word, from its root
+/// \param	len		Word length
 // ===========================================================================
-S_WordNode* Dictionary::GetWordNode (int idx) const
+void Dictionary::UpdateSummaries (const uint8_t* entry, const int path [], int len)
 {
-	if (idx < 0 || (unsigned int) idx >= numWordNodes) return nullptr;
+	uint64_t summary [MAX_WORD_LENGTH];
+
+	// Node at depth i gets the letters found 2, 3, ... levels below it
+	for (int i = 0; i < len - 1; i ++)
+	{
+		int size = len - i - 1;
+		const uint64_t* pSummary = GetSummary (path [i]);
+		bool changed = pSummary == nullptr;
+
+		for (int k = 0; k < size; k ++)
+		{
+			summary [k] = (pSummary != nullptr ? pSummary [k] : 0) | 1ULL << (entry [i + 1 + k] -1);
+			if (pSummary != nullptr && summary [k] != pSummary [k]) changed = true;
+		}
+		if (changed == false) continue;
+
+		if (pSummary != nullptr) lostSummaries += size;
+		int idxSummary = NewSummaries (size);
+		if (idxSummary < 0) return;
 
-	int* location = &vWordNodes [idx * this->alphabetSize];
-	return reinterpret_cast<S_WordNode*> (location);
+		memcpy (vSummaries + idxSummary, summary, sizeof (uint64_t) * size);
+		SetSummary (path [i], idxSummary);
+	}
 }
 
 
 // ===========================================================================
-/// \brief	Convert a pool index into a Trie leaf
+/// \brief	Sort a batch of words and add them to the dictionary
 ///
-/// \param	idx		Index to convert
+/// \param	batch		Words, each one null terminated in a slot of LOAD_ENTRY_SIZE bytes
+///						Letters are in the range [1..alphabetSize]
+/// \param	numWords	Number of words in the batch
 ///
-/// \return	Trie leaf. Null if index out of bounds.
+/// \return	Number of words added
 // ===========================================================================
-S_WordLeaf* Dictionary::GetWordLeaf (int idx) const
+int32_t Dictionary::AddBatch (uint8_t* batch, int numWords)
 {
-	if (idx < 0 || (unsigned int) idx >= numWordLeafs) return nullptr;
-	return (&vWordLeafs [idx]);
+	int32_t count = 0;
+
+	qsort (batch, numWords, LOAD_ENTRY_SIZE, CompareBatchEntries);
+
+	for (int i = 0; i < numWords; i ++)
+	{
+		if (AddEntry (batch + i * LOAD_ENTRY_SIZE)) count ++;
+	}
+
+	return count;
 }
 
 
 // ===========================================================================
-/// \brief	Convert a Trie node pointer into a pool index (independent of pool location)
+/// \brief	Return the index of the sub node (or leaf) following a letter
 ///
-/// \param	p		Pointer to convert
+/// \param	idxNode		Index of the parent node
+/// \param	idxLetter	Letter to follow (0..alphabetSize-1)
 ///
-/// \return	Trie node index. -1 if invalid pointer.
+/// \return	Index of the sub node, or of the leaf if the parent is on the last letter.
+///			-1 if no word follows this letter.
 // ===========================================================================
-int Dictionary::MakeIndex (S_WordNode* p) const
+inline int Dictionary::GetChild (int idxNode, int idxLetter) const
 {
-	uint64_t idx = reinterpret_cast<int*> (p) - vWordNodes;
-	idx /= this->alphabetSize;
+	if (layout == DENSE) return vWordNodes [idxNode * denseStride + DENSE_HEADER + idxLetter];
 
-	if (idx >= numWordNodes) return -1;
-	return (int) idx;
+	const S_CompactNode& node = vCompactNodes [idxNode];
+	uint64_t bit = 1ULL << idxLetter;
+
+	if ((node.children & bit) == 0) return -1;
+	return vCompactLinks [node.first + PopCount (node.children & (bit - 1))];
+}
+
+
+// ===========================================================================
+/// \brief	Return the letters that lead to a sub node (or leaf)
+///
+/// \param	idxNode		Index of the parent node
+///
+/// \return	One bit per existing child, same layout as LetterCandidates::flags
+// ===========================================================================
+inline uint64_t Dictionary::GetChildren (int idxNode) const
+{
+	if (layout == DENSE)
+	{
+		uint64_t children;
+		memcpy (&children, &vWordNodes [idxNode * denseStride], sizeof (children));
+		return children;
+	}
+	return vCompactNodes [idxNode].children;
+}
+
+
+// ===========================================================================
+/// \brief	Return the per-depth letter summary of a node
+///
+/// \param	idxNode		Index of the node
+///
+/// \return	Summary (see BuildSummaries), null if not available
+// ===========================================================================
+inline const uint64_t* Dictionary::GetSummary (int idxNode) const
+{
+	int idx;
+
+	if (layout == DENSE) idx = vWordNodes [idxNode * denseStride + DENSE_SUMMARY];
+	else idx = vCompactNodes [idxNode].summary;
+
+	if (idx < 0) return nullptr;
+	return vSummaries + idx;
+}
+
+
+// ===========================================================================
+/// \brief	Attach a summary to a node
+///
+/// \param	idxNode		Index of the node
+/// \param	idxSummary	Index of the summary in the summaries pool, -1 if none
+// ===========================================================================
+inline void Dictionary::SetSummary (int idxNode, int idxSummary)
+{
+	if (layout == DENSE) vWordNodes [idxNode * denseStride + DENSE_SUMMARY] = idxSummary;
+	else vCompactNodes [idxNode].summary = idxSummary;
+}
+
+
+// ===========================================================================
+/// \brief	Tell if a node subtree may contain a word satisfying some constraints.
+///
+/// This is a necessary condition only, the summaries merging the whole subtree.
+///
+/// \param	idxNode		Index of the node
+/// \param	allowed		Letters allowed at each level, starting at the node children
+/// \param	numLevels	Number of levels to check (from the node children)
+///
+/// \return	False if no word of the subtree can satisfy the constraints
+// ===========================================================================
+inline bool Dictionary::IsViable (int idxNode, const uint64_t allowed [], int numLevels) const
+{
+	if ((GetChildren (idxNode) & allowed [0]) == 0) return false;
+
+	const uint64_t* pSummary = GetSummary (idxNode);
+	if (pSummary == nullptr) return true;
+
+	for (int k = 1; k < numLevels; k ++)
+	{
+		if ((pSummary [k-1] & allowed [k]) == 0) return false;
+	}
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Compute the letters allowed at each depth of a query
+///
+/// \param[out]	allowed				Allowed letters, for each depth
+/// \param		maskEntry			Processed mask (see ProcessEntry)
+/// \param		maskLen				Mask length
+/// \param		possibleLetters		Letter candidates (can be null)
+///
+/// \return		Last depth that is actually constrained, -1 if none
+// ===========================================================================
+int Dictionary::BuildAllowedLetters (uint64_t allowed [], const uint8_t maskEntry [], int maskLen, const LetterCandidates possibleLetters []) const
+{
+	uint64_t alphabet = LowBits (alphabetSize);
+	int lastConstraint = -1;
+
+	for (int i = 0; i < maskLen; i ++)
+	{
+		// Letters from the mask prevail on the candidates
+		if (maskEntry [i] != WILDCARD) allowed [i] = 1ULL << (maskEntry [i] -1);
+		else if (possibleLetters != nullptr) allowed [i] = possibleLetters [i].flags & alphabet;
+		else allowed [i] = alphabet;
+
+		if (allowed [i] != alphabet) lastConstraint = i;
+	}
+
+	return lastConstraint;
+}
+
+
+// ===========================================================================
+/// \brief	Link a sub node (or leaf) to a parent node
+///
+/// In the COMPACT layout, the letter must not be linked already.
+///
+/// \param	idxNode		Index of the parent node
+/// \param	idxLetter	Letter leading to the sub node (0..alphabetSize-1)
+/// \param	idxChild	Index of the sub node (or leaf)
+// ===========================================================================
+void Dictionary::SetChild (int idxNode, int idxLetter, int idxChild)
+{
+	if (layout == DENSE)
+	{
+		vWordNodes [idxNode * denseStride + DENSE_HEADER + idxLetter] = idxChild;
+
+		uint64_t children = GetChildren (idxNode) | 1ULL << idxLetter;
+		memcpy (&vWordNodes [idxNode * denseStride], &children, sizeof (children));
+		return;
+	}
+
+	uint64_t children = vCompactNodes [idxNode].children;
+	uint64_t bit = 1ULL << idxLetter;
+	int first = vCompactNodes [idxNode].first;
+	int count = PopCount (children);
+	int rank = PopCount (children & (bit - 1));
+
+	// Node links at the end of the pool ? Grow them in place
+	if (count > 0 && (unsigned int) (first + count) == usedCompactLinks)
+	{
+		if (NewCompactLinks (1) < 0) return;
+	}
+
+	// Otherwise, move them at the end of the pool, with room for the new one
+	else
+	{
+		int newFirst = NewCompactLinks (count + 1);
+		if (newFirst < 0) return;
+
+		memcpy (vCompactLinks + newFirst, vCompactLinks + first, sizeof (int) * count);
+		lostCompactLinks += count;
+		first = newFirst;
+	}
+
+	// Insert the new link, letters order being preserved
+	memmove (vCompactLinks + first + rank + 1, vCompactLinks + first + rank, sizeof (int) * (count - rank));
+	vCompactLinks [first + rank] = idxChild;
+
+	vCompactNodes [idxNode].first = first;
+	vCompactNodes [idxNode].children = children | bit;
+}
+
+
+// ===========================================================================
+/// \brief	Convert a pool index into a Trie leaf
+///
+/// \param	idx		Index to convert
+///
+/// \return	Trie leaf. Null if index out of bounds.
+// ===========================================================================
+S_WordLeaf* Dictionary::GetWordLeaf (int idx) const
+{
+	if (idx < 0 || (unsigned int) idx >= numWordLeafs) return nullptr;
+	return (&vWordLeafs [idx]);
 }
 
 
@@ -712,45 +1808,136 @@ int Dictionary::MakeIndex (S_WordLeaf* p) const
 // ===========================================================================
 /// \brief	Allocate a new Trie node from the pool. 
 ///
-/// If pool is not big enough, pool is resized. However it means that
-/// pointer to nodes are not valid anymore.
+/// If pool is not big enough, pool is resized.
 ///
-/// \return	Trie node.
+/// \return	Trie node index, -1 in case of failure.
 // ===========================================================================
-S_WordNode* Dictionary::NewWordNode ()
+int Dictionary::NewWordNode ()
 {
 	if (usedWordNodes >= numWordNodes)
 	{
 		unsigned int newSize;
-		int *pNewTab;
 
 		// New pool size
 		newSize = (unsigned int) (numWordNodes * 1.4f);
 		if (newSize == 0) newSize = 10000;
 
-		// Create new pool (each S_WordNode size is (int x alphabetSize))
-		pNewTab = new int [(size_t) newSize * this->alphabetSize];
-		if (pNewTab == nullptr) return nullptr;
+		if (layout == DENSE)
+		{
+			// Create new pool (each node size is (int x denseStride))
+			int *pNewTab = new int [(size_t) newSize * denseStride];
+			if (pNewTab == nullptr) return -1;
+
+			// Copy old to new and init the rest to -1
+			memcpy (pNewTab, vWordNodes, sizeof (int) * denseStride * usedWordNodes);
+			memset (
+				pNewTab + (size_t) denseStride * usedWordNodes,
+				-1,
+				sizeof (int) * denseStride  * (newSize -  usedWordNodes));
+
+			delete [] vWordNodes;	
+			vWordNodes = pNewTab;
+		}
+		else
+		{
+			S_CompactNode *pNewTab = new S_CompactNode [newSize];
+			if (pNewTab == nullptr) return -1;
 
-		// Copy old to new and init the rest to -1
-		memcpy (pNewTab, vWordNodes, sizeof (int) * this->alphabetSize * usedWordNodes);
-		memset (
-			pNewTab + (size_t) this->alphabetSize * usedWordNodes,
-			-1,
-			sizeof (int) * this->alphabetSize  * (newSize -  usedWordNodes));
+			memcpy (pNewTab, vCompactNodes, sizeof (S_CompactNode) * usedWordNodes);
+			delete [] vCompactNodes;
+			vCompactNodes = pNewTab;
+		}
 
-		delete [] vWordNodes;	
-		vWordNodes = pNewTab;
 		numWordNodes = newSize;
+	}
 
-		// Update root nodes
-		for (int i = 0; i < this->maxWordSize; i++) vRootNodes[i] = GetWordNode (i);
+	// A new node has no child and no summary
+	if (layout == COMPACT)
+	{
+		vCompactNodes [usedWordNodes].children = 0;
+		vCompactNodes [usedWordNodes].first = 0;
+	}
+	else
+	{
+		uint64_t children = 0;
+		memcpy (&vWordNodes [usedWordNodes * denseStride], &children, sizeof (children));
 	}
+	SetSummary (usedWordNodes, -1);
 
-	int* location = &vWordNodes [usedWordNodes * this->alphabetSize];
 	usedWordNodes ++;
+	return usedWordNodes -1;
+}
+
+
+// ===========================================================================
+/// \brief	Allocate consecutive child links from the pool (COMPACT layout only).
+///
+/// If pool is not big enough, pool is resized.
+///
+/// \param	count	Number of links to allocate
+///
+/// \return	Index of the first allocated link, -1 in case of failure.
+// ===========================================================================
+int Dictionary::NewCompactLinks (int count)
+{
+	if (usedCompactLinks + count > numCompactLinks)
+	{
+		unsigned int newSize;
+		int *pNewTab;
+
+		// New pool size
+		newSize = (unsigned int) (numCompactLinks * 1.4f);
+		if (newSize < 10000) newSize = 10000;
+		if (newSize < usedCompactLinks + count) newSize = usedCompactLinks + count;
+
+		pNewTab = new int [newSize];
+		if (pNewTab == nullptr) return -1;
+
+		memcpy (pNewTab, vCompactLinks, sizeof (int) * usedCompactLinks);
+		delete [] vCompactLinks;
+
+		vCompactLinks = pNewTab;
+		numCompactLinks = newSize;
+	}
+
+	usedCompactLinks += count;
+	return usedCompactLinks - count;
+}
+
+
+// ===========================================================================
+/// \brief	Allocate consecutive summary masks from the pool.
+///
+/// If pool is not big enough, pool is resized.
+///
+/// \param	count	Number of masks to allocate
+///
+/// \return	Index of the first allocated mask, -1 in case of failure.
+// ===========================================================================
+int Dictionary::NewSummaries (int count)
+{
+	if (usedSummaries + count > numSummaries)
+	{
+		unsigned int newSize;
+		uint64_t *pNewTab;
+
+		// New pool size
+		newSize = (unsigned int) (numSummaries * 1.4f);
+		if (newSize < 10000) newSize = 10000;
+		if (newSize < usedSummaries + count) newSize = usedSummaries + count;
+
+		pNewTab = new uint64_t [newSize];
+		if (pNewTab == nullptr) return -1;
+
+		memcpy (pNewTab, vSummaries, sizeof (uint64_t) * usedSummaries);
+		delete [] vSummaries;
+
+		vSummaries = pNewTab;
+		numSummaries = newSize;
+	}
 
-	return reinterpret_cast<S_WordNode*> (location);
+	usedSummaries += count;
+	return usedSummaries - count;
 }
 
 
@@ -791,4 +1978,4 @@ S_WordLeaf* Dictionary::NewWordLeaf ()
 
 
 
-// End
+// End
\ No newline at end of file
@@ -23,6 +23,7 @@
 #define __DICTIONARY__H
 
 #include <stdint.h>
+#include <stddef.h>
 
 // ===========================================================================
 // D E F I N E S
@@ -39,8 +40,10 @@ constexpr auto MAX_WORD_LENGTH = 40;
 //
 // ###########################################################################
 
-struct S_WordNode;
+struct S_CompactNode;
 struct S_WordLeaf;
+class MappedFile;
+class Random;
 
 /// Letter candidates for a given position in a word.
 struct LetterCandidates
@@ -73,7 +76,16 @@ class Dictionary
 
 public :
 
-	Dictionary (int alphabetSize, int maxWordSize);
+	/// Memory layout of the trie nodes
+	enum Layout 
+	{
+		DENSE,			///< One child index per alphabet letter (fast insertion, big memory footprint)
+		COMPACT			///< Child bitmap + packed child indices (small memory footprint)
+	};
+
+public :
+
+	Dictionary (int alphabetSize, int maxWordSize, Layout layout = DENSE);
 	Dictionary () = delete;
 	~Dictionary ();
 
@@ -81,60 +93,118 @@ public :
 
 	void Clear ();
 	int32_t AddEntries (const uint8_t* tabEntries, int32_t entrySize, int32_t numWords);
+	int32_t LoadFromFile (const char* path, int32_t* pNumRejected = nullptr);
+
+	bool SaveImage (const char* path) const;
+	bool LoadImage (const char* path);
 	
 	bool FindEntry (uint8_t result [], const uint8_t mask [], const uint8_t startWord [] = nullptr, const LetterCandidates possibleLetters [] = nullptr) const;
-	bool FindRandomEntry (uint8_t result [], const uint8_t mask [], const LetterCandidates possibleLetters [] = nullptr) const;
+	bool FindRandomEntry (uint8_t result [], const uint8_t mask [], Random& rng, const LetterCandidates possibleLetters [] = nullptr) const;
+	bool Exists (const uint8_t mask [], const LetterCandidates possibleLetters [] = nullptr) const;
+	int32_t CountMatches (const uint8_t mask [], const LetterCandidates possibleLetters [] = nullptr, int32_t limit = -1) const;
+	uint64_t MatchingLetters (const uint8_t mask [], int pos, const LetterCandidates possibleLetters [] = nullptr) const;
 
 	uint32_t GetNumWords () const {return usedWordLeafs - alphabetSize;}
 	uint8_t AlphabetSize () const { return alphabetSize; }
 	uint8_t MaxWordSize () const { return maxWordSize; }
+	Layout GetLayout () const { return layout; }
+	uint64_t GetRevision () const { return revision; }
+	size_t GetMemoryUsage () const;
+
+	int ProcessEntry (const uint8_t* entry, uint8_t* out) const;
 
 private :
 
 	void Clean ();
+	void Detach ();
+	void Compact ();
+	void BuildSummaries ();
+	void UpdateSummaries (const uint8_t* entry, const int path [], int len);
 
-	int ProcessEntry (const uint8_t* entry, uint8_t* out) const;
 	bool AddEntry (const uint8_t* entry);
-
-	S_WordNode* GetWordNode (int idx) const;
+	int32_t AddBatch (uint8_t* batch, int numWords);
+
+	int GetChild (int idxNode, int idxLetter) const;
+	uint64_t GetChildren (int idxNode) const;
+	const uint64_t* GetSummary (int idxNode) const;
+	void SetSummary (int idxNode, int idxSummary);
+	bool IsViable (int idxNode, const uint64_t allowed [], int numLevels) const;
+	int BuildAllowedLetters (uint64_t allowed [], const uint8_t maskEntry [], int maskLen, const LetterCandidates possibleLetters []) const;
+	void SetChild (int idxNode, int idxLetter, int idxChild);
 	S_WordLeaf* GetWordLeaf (int idx) const;
 
-	S_WordNode* NewWordNode ();
+	int NewWordNode ();
+	int NewCompactLinks (int count);
+	int NewSummaries (int count);
 	S_WordLeaf* NewWordLeaf ();
 
-	int MakeIndex (S_WordNode* p) const;
 	int MakeIndex (S_WordLeaf* p) const;
 
 
 private :
 
+	/// Trie nodes pool (for fast allocation), DENSE layout
+	int* vWordNodes;
 
-	/// Trie root node for every possible word length
-	struct S_WordNode **vRootNodes;
+	/// Trie nodes pool (for fast allocation), COMPACT layout
+	struct S_CompactNode* vCompactNodes;
 
-	/// Trie nodes pool (for fast allocation)
-	int* vWordNodes;
+	/// Packed child indices of the COMPACT trie nodes
+	int* vCompactLinks;
 
 	/// Trie leaves pool (for fast allocation)
 	struct S_WordLeaf* vWordLeafs;
 
+	/// Per-depth letter summaries of the trie nodes (shared between identical subtrees)
+	uint64_t* vSummaries;
+
 	/// Nodes pool size
 	unsigned int numWordNodes;
 
+	/// Compact links pool size
+	unsigned int numCompactLinks;
+
 	/// Leaves pool size
 	unsigned int numWordLeafs;
 
+	/// Summaries pool size
+	unsigned int numSummaries;
+
 	/// Number of nodes used in the pool
 	unsigned int usedWordNodes;
 
+	/// Number of compact links used in the pool (holes included)
+	unsigned int usedCompactLinks;
+
+	/// Number of compact links left unused after node growth
+	unsigned int lostCompactLinks;
+
 	/// Number of leaves used in the pool
 	unsigned int usedWordLeafs;
 
+	/// Number of summary masks used in the pool (replaced ones included)
+	unsigned int usedSummaries;
+
+	/// Number of summary masks replaced since the summaries have been built
+	unsigned int lostSummaries;
+
 	/// Size of the alphabet, according to user config
 	int alphabetSize;
 
 	/// Max size of a word, according to user config
 	int maxWordSize;
+
+	/// Number of ints of a DENSE node (header + one index per letter)
+	int denseStride;
+
+	/// Trie nodes memory layout
+	Layout layout;
+
+	/// Image file the pools are mapped from (null if the pools are allocated)
+	MappedFile* pImage;
+
+	/// Stamp of the current content, unique among all the dictionaries. Changes on each modification
+	uint64_t revision;
 };
 
 
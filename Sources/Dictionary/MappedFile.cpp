@@ -0,0 +1,159 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		MappedFile.cpp
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Read-only file mapped in memory
+// ###########################################################################
+
+#include "libWizium.h"
+#include "MappedFile.h"
+
+#ifdef PL_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+
+// ###########################################################################
+//
+// P U B L I C
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief		Constructor
+// ===========================================================================
+MappedFile::MappedFile ()
+{
+	pData = nullptr;
+	size = 0;
+	isOpen = false;
+	hFile = nullptr;
+	hMapping = nullptr;
+}
+
+
+// ===========================================================================
+/// \brief		Destructor
+// ===========================================================================
+MappedFile::~MappedFile ()
+{
+	Close ();
+}
+
+
+// ===========================================================================
+/// \brief		Map a whole file in memory, read-only
+///
+/// \param		path		File to map
+///
+/// \return		True in case of success
+// ===========================================================================
+bool MappedFile::Open (const char* path)
+{
+	Close ();
+	if (path == nullptr) return false;
+
+#ifdef PL_WINDOWS
+	HANDLE file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx (file, &fileSize) == FALSE)
+	{
+		CloseHandle (file);
+		return false;
+	}
+	hFile = file;
+	size = (size_t) fileSize.QuadPart;
+
+	// Empty files cannot be mapped
+	if (size > 0)
+	{
+		HANDLE mapping = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+		{
+			CloseHandle (file);
+			hFile = nullptr;
+			return false;
+		}
+		hMapping = mapping;
+		pData = static_cast<const uint8_t*> (MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+#else
+	int fd = open (path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat (fd, &st) != 0)
+	{
+		close (fd);
+		return false;
+	}
+	size = (size_t) st.st_size;
+
+	// Empty files cannot be mapped. The mapping stays valid once the file is closed
+	if (size > 0)
+	{
+		void* p = mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) pData = static_cast<const uint8_t*> (p);
+	}
+	close (fd);
+#endif
+
+	// Mapping failure
+	if (size > 0 && pData == nullptr)
+	{
+		Close ();
+		return false;
+	}
+
+	isOpen = true;
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief		Unmap the file
+// ===========================================================================
+void MappedFile::Close ()
+{
+#ifdef PL_WINDOWS
+	if (pData != nullptr) UnmapViewOfFile (pData);
+	if (hMapping != nullptr) CloseHandle (hMapping);
+	if (hFile != nullptr) CloseHandle (hFile);
+#else
+	if (pData != nullptr) munmap (const_cast<uint8_t*> (pData), size);
+#endif
+
+	pData = nullptr;
+	size = 0;
+	isOpen = false;
+	hFile = nullptr;
+	hMapping = nullptr;
+}
+
+
+
+// End
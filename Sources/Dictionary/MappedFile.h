@@ -0,0 +1,68 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		MappedFile.h
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Read-only file mapped in memory
+// ###########################################################################
+
+#ifndef __MAPPEDFILE__H
+#define __MAPPEDFILE__H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+// ###########################################################################
+//
+// P R O T O T Y P E S
+//
+// ###########################################################################
+
+/// Read-only view of a whole file, mapped in memory.
+/// Pages are shared with the other processes mapping the same file.
+class MappedFile
+{
+
+public :
+
+	MappedFile ();
+	~MappedFile ();
+
+	MappedFile (const MappedFile&) = delete;
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	bool Open (const char* path);
+	void Close ();
+
+	bool IsOpen () const { return isOpen; }
+	const uint8_t* GetData () const { return pData; }
+	size_t GetSize () const { return size; }
+
+private :
+
+	const uint8_t* pData;		///< File content, null if empty
+	size_t size;				///< File size in bytes
+	bool isOpen;				///< True if a file is opened
+
+	void* hFile;				///< File handle (Windows only)
+	void* hMapping;				///< File mapping handle (Windows only)
+};
+
+
+#endif
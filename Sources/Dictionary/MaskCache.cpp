@@ -0,0 +1,170 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		MaskCache.cpp
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Bounded cache telling if a mask matches some dictionary word
+// ###########################################################################
+
+#include "libWizium.h"
+#include "MaskCache.h"
+
+#include <string.h>
+
+
+// ===========================================================================
+// T Y P E S
+// ===========================================================================
+
+/// Cached answer for a single (processed) mask
+struct MaskCache::S_Entry
+{
+	uint32_t lastUse;					///< Clock value of the last access, 0 if the entry is free
+	uint8_t length;						///< Mask length
+	bool exists;						///< True if at least one word matches the mask
+	uint8_t key [MAX_WORD_LENGTH];		///< Processed mask
+};
+
+
+
+// ###########################################################################
+//
+// P U B L I C
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief		Constructor
+///
+/// \param		numEntries		Max. number of masks to remember (rounded up to
+///								a multiple of WAYS that is a power of 2)
+// ===========================================================================
+MaskCache::MaskCache (int numEntries)
+{
+	numSets = 1;
+	while ((int) (numSets * WAYS) < numEntries) numSets <<= 1;
+
+	vEntries = new S_Entry [numSets * WAYS];
+	Reset (nullptr);
+}
+
+
+// ===========================================================================
+/// \brief		Destructor
+// ===========================================================================
+MaskCache::~MaskCache ()
+{
+	delete [] vEntries;
+}
+
+
+// ===========================================================================
+/// \brief		Forget all the cached answers and reset the counters
+///
+/// \param		pDict		Dictionary the answers must be taken from
+// ===========================================================================
+void MaskCache::Reset (const Dictionary *pDict)
+{
+	this->pDict = pDict;
+	this->revision = pDict != nullptr ? pDict->GetRevision () : 0;
+	this->clock = 0;
+	this->hits = 0;
+	this->misses = 0;
+
+	for (unsigned int i = 0; i < numSets * WAYS; i ++) vEntries [i].lastUse = 0;
+}
+
+
+// ===========================================================================
+/// \brief		Use a dictionary, keeping the cached answers if they come from 
+///				the same dictionary content. Counters are reset.
+///
+/// \param		pDict		Dictionary the answers must be taken from
+// ===========================================================================
+void MaskCache::Attach (const Dictionary *pDict)
+{
+	if (pDict == nullptr || pDict != this->pDict || pDict->GetRevision () != this->revision)
+	{
+		Reset (pDict);
+		return;
+	}
+
+	this->hits = 0;
+	this->misses = 0;
+}
+
+
+// ===========================================================================
+/// \brief	Tell if at least one dictionary word matches a mask.
+///
+/// Same as calling Exists on the dictionary, but the answer is remembered
+///
+/// \param	mask		Mask enabling to force some letters (see Dictionary::FindEntry)
+///
+/// \return	True if a match exists
+// ===========================================================================
+bool MaskCache::Exists (const uint8_t mask [])
+{
+	uint8_t key [MAX_WORD_LENGTH];
+
+	if (pDict == nullptr) return false;
+
+	// Work on the processed mask, so that equivalent masks share the same entry
+	int length = pDict->ProcessEntry (mask, key);
+	if (length == 0) return false;
+
+	// Mask hash (FNV-1a) gives the set to look into
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < length; i ++) hash = (hash ^ key [i]) * 16777619u;
+	S_Entry* pSet = vEntries + (hash & (numSets -1)) * WAYS;
+
+	// Clock wrap around: forget everything rather than messing the LRU order
+	if (++clock == 0)
+	{
+		for (unsigned int i = 0; i < numSets * WAYS; i ++) vEntries [i].lastUse = 0;
+		clock = 1;
+	}
+
+	// Look for the mask in the set, and for the entry to replace in case it is not there
+	S_Entry* pVictim = pSet;
+	for (int i = 0; i < WAYS; i ++)
+	{
+		S_Entry& entry = pSet [i];
+
+		if (entry.lastUse != 0 && entry.length == length && memcmp (entry.key, key, length) == 0)
+		{
+			entry.lastUse = clock;
+			hits ++;
+			return entry.exists;
+		}
+		if (entry.lastUse < pVictim->lastUse) pVictim = &entry;
+	}
+
+	// Not found, ask the dictionary and remember the answer
+	misses ++;
+	pVictim->lastUse = clock;
+	pVictim->length = length;
+	pVictim->exists = pDict->Exists (mask);
+	memcpy (pVictim->key, key, length);
+
+	return pVictim->exists;
+}
+
+
+
+// End
@@ -0,0 +1,79 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		MaskCache.h
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Bounded cache telling if a mask matches some dictionary word
+// ###########################################################################
+
+#ifndef __MASKCACHE__H
+#define __MASKCACHE__H
+
+#include "Dictionary.h"
+
+
+// ###########################################################################
+//
+// P R O T O T Y P E S
+//
+// ###########################################################################
+
+/// Memoisation of the "does any word match this mask" queries.
+/// Entries are grouped in small sets of 'WAYS' entries selected by the mask hash.
+/// When a set is full, its least recently used entry is replaced.
+class MaskCache
+{
+
+public :
+
+	MaskCache (int numEntries = 16384);
+	~MaskCache ();
+
+	MaskCache (const MaskCache&) = delete;
+	MaskCache& operator = (const MaskCache&) = delete;
+
+	void Reset (const Dictionary *pDict);
+	void Attach (const Dictionary *pDict);
+	bool Exists (const uint8_t mask []);
+
+	uint64_t GetHits () const { return hits; }
+	uint64_t GetMisses () const { return misses; }
+	void ResetCounters () { hits = misses = 0; }
+
+private :
+
+	struct S_Entry;
+
+	/// Number of entries in a set
+	static constexpr int WAYS = 4;
+
+private :
+
+	const Dictionary *pDict;	///< Dictionary to query on cache miss
+	uint64_t revision;			///< Dictionary revision the answers are taken from
+
+	S_Entry* vEntries;			///< Entries pool
+	unsigned int numSets;		///< Number of sets (power of 2)
+	uint32_t clock;				///< Incremented on each access, to track the least recently used entries
+
+	uint64_t hits;				///< Number of queries answered from the cache
+	uint64_t misses;			///< Number of queries that needed a dictionary search
+};
+
+
+#endif
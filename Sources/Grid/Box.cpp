@@ -86,6 +86,19 @@ void Box::MakeVoid ()
 }
 
 
+// ===========================================================================
+/// \brief		Turn the box into a sentinel lying outside the grid. It cannot be
+///				changed afterwards.
+// ===========================================================================
+void Box::MakeBorder ()
+{
+	type = 'X';
+	value = 0;
+	counter = 0;
+	isLocked = true;
+}
+
+
 // ===========================================================================
 /// \brief		Return the letter stored in the box.
 ///
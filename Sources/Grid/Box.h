@@ -43,10 +43,12 @@ public :
 	void MakeBloc ();
 	void MakeLetter ();
 	void MakeVoid ();
+	void MakeBorder ();
 
 	bool IsBloc () const {return type == 'B';}
 	bool IsLetter () const {return type == 'L';}
 	bool IsVoid () const {return type == 'V';}
+	bool IsBorder () const {return type == 'X';}
 	bool IsLocked () const {return isLocked;}
 
 	uint8_t GetLetter () const;
@@ -76,13 +78,13 @@ public :
 
 private :
 
-	char type;				///< Box type (letter, void, block)
+	char type;				///< Box type (letter, void, block, or border outside the grid)
 	uint8_t value;			///< Letter in this box or block local densisty (depending on box purpose)
 	int8_t counter;			///< Counter used to track how many time the same content has been written in this box
-	int failCounter;		///< Counter used to track how many time this box is implicated in a failure
-
 	bool isLocked;			///< Content is locked
 
+	int failCounter;		///< Counter used to track how many time this box is implicated in a failure
+
 	LetterCandidates candidates;	///< Letter candidates for this box
 };
 
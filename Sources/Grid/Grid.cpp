@@ -22,7 +22,9 @@
 // ###########################################################################
 
 #include "Grid.h"
+#include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 
 // ###########################################################################
@@ -37,9 +39,18 @@
 Grid::Grid ()
 {
 	mpTabCases = nullptr;
+	mpColumns = nullptr;
+	freeBoxes = nullptr;
+	blocBoard = nullptr;
+	freeBlocBoard = nullptr;
+	mBoardStride = 1;
 	mSx = mSy = 0;
+	mStride = 2;
 	densityMode = DIAG;
 	numBlackCases = 0;
+	numVoidBoxes = 0;
+	numFreeBoxes = 0;
+	crossings = nullptr;
 }
 
 
@@ -49,6 +60,11 @@ Grid::Grid ()
 Grid::~Grid ()
 {
 	if (mpTabCases != nullptr) delete [] mpTabCases;
+	delete [] mpColumns;
+	delete [] freeBoxes;
+	delete [] blocBoard;
+	delete [] freeBlocBoard;
+	delete [] crossings;
 }
 
 
@@ -65,7 +81,7 @@ Box* Grid::operator () (int x, int y)
 	if (y < 0 || y >= mSy) return nullptr;
 	if (x < 0 || x >= mSx) return nullptr;
 
-	return &mpTabCases [y*mSx + x];
+	return &mpTabCases [(y+1)*mStride + x+1];
 }
 
 
@@ -82,7 +98,7 @@ const Box* Grid::operator () (int x, int y) const
 	if (y < 0 || y >= mSy) return nullptr;
 	if (x < 0 || x >= mSx) return nullptr;
 
-	return &mpTabCases [y*mSx + x];
+	return &mpTabCases [(y+1)*mStride + x+1];
 }
 
 
@@ -95,10 +111,61 @@ const Box* Grid::operator () (int x, int y) const
 void Grid::Grow (uint8_t sx, uint8_t sy)
 {
 	if (mpTabCases != nullptr) delete [] mpTabCases;
-	mpTabCases = new Box [sx*sy];
+	mpTabCases = new Box [(sx+2)*(sy+2)];
 
 	mSx = sx;
 	mSy = sy;
+	mStride = sx+2;
+
+	// Surround the grid with sentinel boxes
+	for (int i = 0; i < mStride; i ++)
+	{
+		mpTabCases [i].MakeBorder ();
+		mpTabCases [(mSy+1)*mStride + i].MakeBorder ();
+	}
+	for (int j = 1; j <= mSy; j ++)
+	{
+		mpTabCases [j*mStride].MakeBorder ();
+		mpTabCases [j*mStride + mStride-1].MakeBorder ();
+	}
+
+	delete [] mpColumns;
+	delete [] freeBoxes;
+	delete [] blocBoard;
+	delete [] freeBlocBoard;
+	mpColumns = new uint8_t [sx*(sy+2)];
+	freeBoxes = new uint64_t [(sx*sy + 63) / 64];
+	mBoardStride = (sx+2 + 63) / 64;
+	blocBoard = new uint64_t [mBoardStride * (sy+2)];
+	freeBlocBoard = new uint64_t [mBoardStride * (sy+2)];
+
+	// New boxes are all empty letters
+	numBlackCases = 0;
+	numVoidBoxes = 0;
+	SyncContent ();
+
+	if (crossings != nullptr) BuildCrossings ();
+}
+
+
+// ===========================================================================
+/// \brief		Make this grid an exact copy of another one (size and content)
+///
+/// \param		grid	Grid to copy
+// ===========================================================================
+void Grid::Copy (const Grid& grid)
+{
+	if (mSx != grid.mSx || mSy != grid.mSy)
+		Grow (static_cast<uint8_t> (grid.mSx), static_cast<uint8_t> (grid.mSy));
+
+	for (int i = 0; i < (mSx+2)*(mSy+2); i ++) mpTabCases [i] = grid.mpTabCases [i];
+
+	densityMode = grid.densityMode;
+	numBlackCases = grid.numBlackCases;
+	numVoidBoxes = grid.numVoidBoxes;
+
+	SyncContent ();
+	if (crossings != nullptr) BuildCrossings ();
 }
 
 
@@ -121,6 +188,9 @@ void Grid::Erase ()
 			if (box->IsVoid ()) numVoidBoxes ++;
 		}
 	}
+
+	SyncContent ();
+	if (crossings != nullptr) BuildCrossings ();
 }
 
 
@@ -157,6 +227,9 @@ void Grid::LockContent ()
 			}
 		}
 	}
+
+	// Boxes may have been written directly since the last update
+	SyncContent ();
 }
 
 
@@ -175,6 +248,9 @@ void Grid::Unlock ()
 			box->Lock (false);
 		}
 	}
+
+	// Black boxes are not locked anymore
+	SyncContent ();
 }
 
 
@@ -212,8 +288,8 @@ void Grid::AddBloc (uint8_t x, uint8_t y)
 
 		for (i = 0; i < 8; i ++)
 		{
-			Box* boxNext = this->operator () (x + tabX [i], y + tabY [i]);
-			if (boxNext != nullptr && boxNext->IsBloc ())
+			Box* boxNext = BoxAt (x + tabX [i], y + tabY [i]);
+			if (boxNext->IsBloc ())
 			{
 				boxNext->SetBlocDensity (boxNext->GetBlocDensity () +1);
 				v ++; 
@@ -222,6 +298,10 @@ void Grid::AddBloc (uint8_t x, uint8_t y)
 
 		// Update target box density
 		box->SetBlocDensity (v);
+		SyncBox (x, y);
+
+		// The vertical slots layout has changed
+		if (crossings != nullptr) BuildCrossings ();
 	}
 
 	// Or increment the box counter
@@ -261,10 +341,14 @@ void Grid::RemoveBloc (uint8_t x, uint8_t y)
 		// Update neighbours density
 		for (i = 0; i < 8; i ++)
 		{
-			Box* boxNext = this->operator () (x + tabX [i], y + tabY [i]);
-			if (boxNext != nullptr && boxNext->IsBloc ())
+			Box* boxNext = BoxAt (x + tabX [i], y + tabY [i]);
+			if (boxNext->IsBloc ())
 				boxNext->SetBlocDensity (boxNext->GetBlocDensity () -1);
 		}
+		SyncBox (x, y);
+
+		// The vertical slots layout has changed
+		if (crossings != nullptr) BuildCrossings ();
 	}	
 }
 
@@ -300,6 +384,9 @@ void Grid::AddWord (uint8_t x, uint8_t y, char dir, const uint8_t* word)
 			{
 				box->SetLetter (word [i]);
 				box->ResetCounter (1);
+
+				if (dir == 'H') SyncBox (x + i, y);
+				else SyncBox (x, y + i);
 			}
 		}
 		// Put a black box
@@ -344,6 +431,9 @@ void Grid::RemoveWord (uint8_t x, uint8_t y, char dir)
 			{
 				box->SetLetter (0);
 				box->ResetCounter (1);
+
+				if (dir == 'H') SyncBox (x + i, y);
+				else SyncBox (x, y + i);
 			}
 		}
 
@@ -400,16 +490,18 @@ void Grid::FailAtColumn (uint8_t x, uint8_t y)
 bool Grid::CheckBlocDensity (uint8_t x, uint8_t y) const
 {
 	const Box *box = this->operator () (x, y);
-
-	int tabX [] = {-1, 0, 1, -1, 1, -1,  0,  1};
-	int tabY [] = { 1, 1, 1,  0, 0, -1, -1, -1};
 	bool good = true;
-	
+
 	// Trivial cases if the box is not empty
 	if (box == nullptr) return false;
 	if (box->IsBloc () == true) return true;
 	if (box->IsLetter () && box->GetLetter () != 0) return false;
 
+	// Unlocked black boxes around, one row at a time (bit 0 is column x-1)
+	uint64_t top = GetBlocBits (freeBlocBoard, x-1, y-1, 3);
+	uint64_t mid = GetBlocBits (freeBlocBoard, x-1, y, 3) & 5;
+	uint64_t bottom = GetBlocBits (freeBlocBoard, x-1, y+1, 3);
+
 	// No black box allowed:
 	if (densityMode == NONE)
 	{
@@ -419,55 +511,22 @@ bool Grid::CheckBlocDensity (uint8_t x, uint8_t y) const
 	}
 
 	// No neighbours:
-	else if (densityMode == SINGLE)
-	{
-		// Check all neighbours
-		for (int j = 0; j < 8; j ++)
-		{
-			box = this->operator () (x + tabX [j], y + tabY [j]);
-			if (box != nullptr && box->IsBloc () && box->IsLocked () == false)
-			{
-				good = false;
-				break;
-			}
-		}
-	}
+	else if (densityMode == SINGLE) good = (top | mid | bottom) == 0;
 
 	// Neighbours must be in diagonal
-	else if (densityMode == DIAG)
-	{
-		for (int j = 0; j < 8; j ++)
-		{
-			box = this->operator () (x+ tabX [j], y + tabY [j]);
-			if (box != nullptr && box->IsBloc () && box->IsLocked () == false) 
-			{
-				if (j == 1 || j == 3 || j == 4 || j == 6) {
-					good = false;
-					break;
-				}
-			}
-		}
-	}
+	else if (densityMode == DIAG) good = ((top | bottom) & 2) == 0 && mid == 0;
 
-	// Only two neighbours
+	// Only two neighbours, that must not have two neighbours themselves
 	else if (densityMode == TWO)
 	{
-		int c = 0;
-		for (int j = 0; j < 8; j ++)
+		uint64_t rows [] = {top, mid, bottom};
+		good = PopCount (top) + PopCount (mid) + PopCount (bottom) <= 2;
+
+		for (int j = 0; j < 3 && good; j ++)
 		{
-			box = this->operator () (x + tabX [j], y + tabY [j]);
-			if (box != nullptr && box->IsBloc () && box->IsLocked () == false) 
+			for (uint64_t bits = rows [j]; bits != 0; bits &= bits - 1)
 			{
-				c ++;
-				if (c > 2) {
-					good = false;
-					break;
-				}
-
-				if (box->GetBlocDensity () >= 2) {
-					good = false;
-					break;
-				}
+				if (BoxAt (x-1 + CountTrailingZeros (bits), y-1 + j)->GetBlocDensity () >= 2) good = false;
 			}
 		}
 	}
@@ -478,55 +537,31 @@ bool Grid::CheckBlocDensity (uint8_t x, uint8_t y) const
 	// . . * . .
 	if (good)
 	{
-		// Black box at the four corners around current case
-		bool p1, p2, p3, p4, pc;
-
-		box = this->operator () (x-1, y-1 );
-		p1 = (box == nullptr || box->IsBloc ());
-
-		box = this->operator () (x+1, y-1 );
-		p2 = (box == nullptr || box->IsBloc ());
-
-		box = this->operator () (x+1, y+1 );
-		p3 = (box == nullptr || box->IsBloc ());
+		// Black boxes (or grid border) around, one row at a time (bit 0 is column x-1)
+		uint64_t above = GetBlocBits (blocBoard, x-1, y-1, 3);
+		uint64_t row = GetBlocBits (blocBoard, x-1, y, 3);
+		uint64_t below = GetBlocBits (blocBoard, x-1, y+1, 3);
 
-		box = this->operator () (x-1, y+1 );
-		p4 = (box == nullptr || box->IsBloc ());
+		// Black box at the four corners around current case
+		bool p1 = (above & 1) != 0;
+		bool p2 = (above & 4) != 0;
+		bool p3 = (below & 4) != 0;
+		bool p4 = (below & 1) != 0;
 
 		// Check we don't close the pattern from the bottom
-		if (p1 && p2 && y >= 1) {
-			box = this->operator () (x, y-1 );
-			pc = (box == nullptr || box->IsBloc ());
+		if (p1 && p2 && y >= 1 && (above & 2) == 0 && GetBlocBits (blocBoard, x, y-2, 1)) good = false;
 
-			box = this->operator () (x, y-2 );
-			if (pc == false && (box == nullptr || box->IsBloc ()) ) good = false;
-		}
 		// Check we don't close the pattern from the right
-		if (p1 && p4 && x >= 1) {
-			box = this->operator () (x-1, y );
-			pc = (box == nullptr || box->IsBloc ());
+		if (p1 && p4 && x >= 1 && (row & 1) == 0 && GetBlocBits (blocBoard, x-2, y, 1)) good = false;
 
-			box = this->operator () (x-2, y );
-			if (pc == false && (box == nullptr || box->IsBloc ()) ) good = false;
-		}
 		// Check we don't close the pattern from the left
-		if (p2 && p3 && x < mSx -1) {
-			box = this->operator () (x+1, y );
-			pc = (box == nullptr || box->IsBloc ());
+		if (p2 && p3 && x < mSx -1 && (row & 4) == 0 && GetBlocBits (blocBoard, x+2, y, 1)) good = false;
 
-			box = this->operator () (x+2, y );
-			if (pc == false && (box == nullptr || box->IsBloc ()) ) good = false;
-		}
 		// Check we don't close the pattern from the top
-		if (p3 && p4 && y < mSy -1) {
-			box = this->operator () (x, y+1 );
-			pc = (box == nullptr || box->IsBloc ());
-
-			box = this->operator () (x, y+2 );
-			if (pc == false && (box == nullptr || box->IsBloc ()) ) good = false;
-		}
+		if (p3 && p4 && y < mSy -1 && (below & 2) == 0 && GetBlocBits (blocBoard, x, y+2, 1)) good = false;
 	}
 
+	assert (good == CheckBlocDensityBoxes (x, y));
 	return good;
 }
 
@@ -552,22 +587,41 @@ unsigned char Grid::BuildMask (uint8_t mask [], uint8_t x, uint8_t y, char dir,
 	unsigned char offset = 0;
 	const Box *box;
 
+	// Vertical masks are contiguous in the column-major letters
+	if (dir == 'V')
+	{
+		const uint8_t* p = ColumnAt (x, y);
+		const uint8_t* columnEnd = ColumnAt (x, mSy);
+
+		if (goBack)
+		{
+			while (p [-1] != 0) p --;
+			offset = static_cast<unsigned char> (ColumnAt (x, y) - p);
+		}
+
+		// Look for the slot end, then copy it
+		const uint8_t* end = static_cast<const uint8_t*> (memchr (p, 0, columnEnd - p + 1));
+		i = static_cast<int> (end - p);
+		memcpy (mask, p, i);
+
+		mask [i] = 0;
+		return offset;
+	}
+
 	// If we have to go back first
 	if (goBack)
 	{
 		// Still possible to go back ?
-		while ((dir == 'H' && x > 0) || (dir == 'V' && y > 0))
+		while (x > 0)
 		{
 			// Go back
-			if (dir == 'H') x --;
-			else y --;
+			x --;
 
 			// We got too far ?
-			box = this->operator ()(x, y);
-			if (box->IsBloc () || box->IsVoid ())
+			box = BoxAt (x, y);
+			if (box->IsLetter () == false)
 			{
-				if (dir == 'H') x ++;
-				else y ++;
+				x ++;
 				break;
 			}
 
@@ -578,15 +632,13 @@ unsigned char Grid::BuildMask (uint8_t mask [], uint8_t x, uint8_t y, char dir,
 	// Move on to build the mask
 	while (true)
 	{
-		box = this->operator ()(x, y);
-		if (box == nullptr) break;
-		if (box->IsBloc () || box->IsVoid ()) break;
+		box = BoxAt (x, y);
+		if (box->IsLetter () == false) break;
 
 		mask [i] = box->GetLetter ();
 		if (mask [i] == 0) mask[i] = '*';
 		
-		if (dir == 'V') y ++;
-		else x ++;
+		x ++;
 
 		i ++;			
 	}	
@@ -615,20 +667,21 @@ Grid::Space Grid::GetSpace (int x, int y) const
 	// Check along 4 directions
 	for (int i = 0; i < 4; i ++)
 	{
-		px = x;
-		py = y;
+		px = x + dirX [i];
+		py = y + dirY [i];
+
+		// Leaving the grid from a location adjacent to it
+		if (px < -1 || px > mSx || py < -1 || py > mSy) continue;
 
-		do
+		// The sentinel border stops the scan
+		box = BoxAt (px, py);
+		while (box->IsLetter ())
 		{
+			tabSpace [i] ++;
 			px += dirX [i];
 			py += dirY [i];
-			
-			box = this->operator ()(px, py);
-			if (box == nullptr || box->IsBloc () || box->IsVoid () ) break;
-
-			tabSpace [i] ++;
+			box = BoxAt (px, py);
 		}
-		while (true);
 	}
 
 	// Return result
@@ -648,24 +701,365 @@ Grid::Space Grid::GetSpace (int x, int y) const
 // ===========================================================================
 int Grid::GetFillRate () const
 {
-	int notVoid = 0;
-	int numVoid = 0;
+	int numUsable = mSx*mSy - numVoidBoxes;
+	return (int) (100 * (numUsable - numFreeBoxes) / numUsable);
+}
+
+
+// ===========================================================================
+/// \brief		Find the first empty letter box, from left to right, then 
+///				from top to bottom
+///
+/// \param[out]	px, py		Coordinates of the box
+///
+/// \return		True if an empty box has been found
+// ===========================================================================
+bool Grid::FindFreeBox (uint8_t *px, uint8_t *py) const
+{
+	if (numFreeBoxes == 0) return false;
+
+	int w = 0;
+	while (freeBoxes [w] == 0) w ++;
+	int idx = w*64 + CountTrailingZeros (freeBoxes [w]);
+
+	if (px != nullptr) *px = static_cast<uint8_t> (idx % mSx);
+	if (py != nullptr) *py = static_cast<uint8_t> (idx / mSx);
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief		Enable or disable the tracking of the vertical slots masks.
+///
+/// When enabled, the vertical slot crossing each box is known in advance, so that
+/// 'GetColumnMask' doesn't have to look for the slot boundaries.
+///
+/// \param		state	True to enable the tracking
+// ===========================================================================
+void Grid::TrackColumns (bool state)
+{
+	delete [] crossings;
+	crossings = nullptr;
+
+	if (state) BuildCrossings ();
+}
+
+
+// ===========================================================================
+/// \brief		Return the tracked mask of the vertical slot crossing a given box.
+///
+/// The mask is the one 'BuildMask' would give for this slot. It can be 
+/// temporarily modified by the caller, as long as it is restored before the
+/// grid content changes.
+///
+/// \param		x,y			Grid location
+/// \param[out]	offset		Box offset in the slot
+/// \param[out]	length		Slot length
+///
+/// \return		Slot mask, or null if there is no slot or the columns are not tracked
+// ===========================================================================
+uint8_t* Grid::GetColumnMask (int x, int y, int& offset, int& length)
+{
+	if (crossings == nullptr) return nullptr;
+
+	const Crossing& crossing = crossings [y*mSx + x];
+	if (crossing.start < 0) return nullptr;
+
+	offset = crossing.offset;
+	length = crossing.length;
+	return mpColumns + crossing.start;
+}
+
+
+// ###########################################################################
+//
+// P R I V A T E
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief		Build the column-major copy of the letters, the empty boxes
+///				tracking and the black boxes bitboards from the boxes content
+// ===========================================================================
+void Grid::SyncContent ()
+{
+	if (mpColumns == nullptr) return;
+
+	memset (mpColumns, 0, mSx*(mSy+2));
+	memset (freeBoxes, 0, sizeof (uint64_t) * ((mSx*mSy + 63) / 64));
+	numFreeBoxes = 0;
+
+	// The grid border counts as black boxes for the diamond pattern check
+	memset (blocBoard, 0, sizeof (uint64_t) * mBoardStride * (mSy+2));
+	memset (freeBlocBoard, 0, sizeof (uint64_t) * mBoardStride * (mSy+2));
+	for (int x = -1; x <= mSx; x ++)
+	{
+		SetBlocBit (blocBoard, x, -1, true);
+		SetBlocBit (blocBoard, x, mSy, true);
+	}
+	for (int y = 0; y < mSy; y ++)
+	{
+		SetBlocBit (blocBoard, -1, y, true);
+		SetBlocBit (blocBoard, mSx, y, true);
+	}
+
+	for (int x = 0; x < mSx; x ++)
+		for (int y = 0; y < mSy; y ++) SyncBox (x, y);
+}
+
+
+// ===========================================================================
+/// \brief		Reflect the content of a box in the column-major letters, 
+///				the empty boxes tracking and the black boxes bitboards
+///
+/// \param		x,y		Grid location
+// ===========================================================================
+void Grid::SyncBox (int x, int y)
+{
+	const Box* box = BoxAt (x, y);
+	uint8_t c = 0;
+
+	if (box->IsLetter ())
+	{
+		c = box->GetLetter ();
+		if (c == 0) c = '*';
+	}
+
+	// Empty box status change
+	uint8_t* column = ColumnAt (x, y);
+	if ((*column == '*') != (c == '*'))
+	{
+		int idx = y*mSx + x;
+		freeBoxes [idx / 64] ^= 1ULL << (idx % 64);
+		numFreeBoxes += c == '*' ? 1 : -1;
+	}
+
+	*column = c;
+
+	// Black boxes bitboards
+	SetBlocBit (blocBoard, x, y, box->IsBloc ());
+	SetBlocBit (freeBlocBoard, x, y, box->IsBloc () && box->IsLocked () == false);
+}
+
+
+// ===========================================================================
+/// \brief		Reference implementation of 'CheckBlocDensity', walking the boxes
+///				one by one. Only used to check the bitboards, in debug builds
+///				and by wizium_grid_check.
+///
+/// \param		x		Grid horizontal location
+/// \param		y		Grid vertical location
+///
+/// \return		True if a black box can be added.
+// ===========================================================================
+bool Grid::CheckBlocDensityBoxes (uint8_t x, uint8_t y) const
+{
+	const Box *box = this->operator () (x, y);
 
-	for (int j = 0; j < mSy; j ++)
+	int tabX [] = {-1, 0, 1, -1, 1, -1,  0,  1};
+	int tabY [] = { 1, 1, 1,  0, 0, -1, -1, -1};
+	bool good = true;
+	
+	// Trivial cases if the box is not empty
+	if (box == nullptr) return false;
+	if (box->IsBloc () == true) return true;
+	if (box->IsLetter () && box->GetLetter () != 0) return false;
+
+	// No black box allowed:
+	if (densityMode == NONE)
 	{
-		for (int i = 0; i < mSx; i ++)
+		// OK if the black box was already there and is locked
+		if (box->IsLocked ()) good = box->IsBloc ();
+		else good = false;
+	}
+
+	// No neighbours:
+	else if (densityMode == SINGLE)
+	{
+		// Check all neighbours
+		for (int j = 0; j < 8; j ++)
 		{
-			if ( this->operator ()(i,j)->IsBloc ()) notVoid ++;
-			else if ( this->operator ()(i,j)->IsLetter ())
+			box = BoxAt (x + tabX [j], y + tabY [j]);
+			if (box->IsBloc () && box->IsLocked () == false)
 			{
-				uint8_t c = (this->operator ()(i,j))->GetLetter ();
-				if (c != 0) notVoid ++;
+				good = false;
+				break;
+			}
+		}
+	}
+
+	// Neighbours must be in diagonal
+	else if (densityMode == DIAG)
+	{
+		for (int j = 0; j < 8; j ++)
+		{
+			box = BoxAt (x + tabX [j], y + tabY [j]);
+			if (box->IsBloc () && box->IsLocked () == false) 
+			{
+				if (j == 1 || j == 3 || j == 4 || j == 6) {
+					good = false;
+					break;
+				}
+			}
+		}
+	}
+
+	// Only two neighbours
+	else if (densityMode == TWO)
+	{
+		int c = 0;
+		for (int j = 0; j < 8; j ++)
+		{
+			box = BoxAt (x + tabX [j], y + tabY [j]);
+			if (box->IsBloc () && box->IsLocked () == false) 
+			{
+				c ++;
+				if (c > 2) {
+					good = false;
+					break;
+				}
+
+				if (box->GetBlocDensity () >= 2) {
+					good = false;
+					break;
+				}
 			}
-			else numVoid ++;
 		}
 	}
 
-	return (int) (100 * notVoid / (mSx*mSy - numVoid));
+	// Check for this unwanted diamond pattern:
+	// . . * . .
+	// . * . * .
+	// . . * . .
+	if (good)
+	{
+		// Black box at the four corners around current case
+		bool p1, p2, p3, p4, pc;
+
+		box = BoxAt (x-1, y-1 );
+		p1 = (box->IsBorder () || box->IsBloc ());
+
+		box = BoxAt (x+1, y-1 );
+		p2 = (box->IsBorder () || box->IsBloc ());
+
+		box = BoxAt (x+1, y+1 );
+		p3 = (box->IsBorder () || box->IsBloc ());
+
+		box = BoxAt (x-1, y+1 );
+		p4 = (box->IsBorder () || box->IsBloc ());
+
+		// Check we don't close the pattern from the bottom
+		if (p1 && p2 && y >= 1) {
+			box = BoxAt (x, y-1 );
+			pc = (box->IsBorder () || box->IsBloc ());
+
+			box = BoxAt (x, y-2 );
+			if (pc == false && (box->IsBorder () || box->IsBloc ()) ) good = false;
+		}
+		// Check we don't close the pattern from the right
+		if (p1 && p4 && x >= 1) {
+			box = BoxAt (x-1, y );
+			pc = (box->IsBorder () || box->IsBloc ());
+
+			box = BoxAt (x-2, y );
+			if (pc == false && (box->IsBorder () || box->IsBloc ()) ) good = false;
+		}
+		// Check we don't close the pattern from the left
+		if (p2 && p3 && x < mSx -1) {
+			box = BoxAt (x+1, y );
+			pc = (box->IsBorder () || box->IsBloc ());
+
+			box = BoxAt (x+2, y );
+			if (pc == false && (box->IsBorder () || box->IsBloc ()) ) good = false;
+		}
+		// Check we don't close the pattern from the top
+		if (p3 && p4 && y < mSy -1) {
+			box = BoxAt (x, y+1 );
+			pc = (box->IsBorder () || box->IsBloc ());
+
+			box = BoxAt (x, y+2 );
+			if (pc == false && (box->IsBorder () || box->IsBloc ()) ) good = false;
+		}
+	}
+
+	return good;
+}
+
+
+// ===========================================================================
+/// \brief		Read consecutive boxes of a row from a black boxes bitboard
+///
+/// \param		board	Bitboard to read
+/// \param		x,y		Location of the first box (-1..width, -1..height)
+/// \param		n		Number of boxes to read (<= 64)
+///
+/// \return		One bit per box, bit 0 being the box at 'x'
+// ===========================================================================
+uint64_t Grid::GetBlocBits (const uint64_t* board, int x, int y, int n) const
+{
+	const uint64_t* row = board + (y+1)*mBoardStride;
+	int pos = x+1;
+	int shift = pos & 63;
+
+	uint64_t bits = row [pos >> 6] >> shift;
+	if (shift + n > 64) bits |= row [(pos >> 6) + 1] << (64 - shift);
+
+	return bits & LowBits (n);
+}
+
+
+// ===========================================================================
+/// \brief		Change the state of a box in a black boxes bitboard
+///
+/// \param		board	Bitboard to update
+/// \param		x,y		Box location (-1..width, -1..height)
+/// \param		state	True if the box must be set
+// ===========================================================================
+void Grid::SetBlocBit (uint64_t* board, int x, int y, bool state)
+{
+	uint64_t* row = board + (y+1)*mBoardStride;
+	int pos = x+1;
+
+	if (state) row [pos >> 6] |= 1ULL << (pos & 63);
+	else row [pos >> 6] &= ~(1ULL << (pos & 63));
+}
+
+
+// ===========================================================================
+/// \brief		Build the vertical slot descriptor of every box
+// ===========================================================================
+void Grid::BuildCrossings ()
+{
+	delete [] crossings;
+	crossings = new Crossing [mSx*mSy > 0 ? mSx*mSy : 1];
+
+	for (int x = 0; x < mSx; x ++)
+	{
+		int y = 0;
+		while (y < mSy)
+		{
+			// No slot in black or void boxes
+			if (*ColumnAt (x, y) == 0)
+			{
+				crossings [y*mSx + x].start = -1;
+				y ++;
+				continue;
+			}
+
+			// Slot extent
+			int y0 = y;
+			while (*ColumnAt (x, y) != 0) y ++;
+
+			// Slot descriptor
+			for (int j = y0; j < y; j ++)
+			{
+				Crossing& crossing = crossings [j*mSx + x];
+				crossing.start = static_cast<int> (ColumnAt (x, y0) - mpColumns);
+				crossing.offset = j - y0;
+				crossing.length = y - y0;
+			}
+		}
+	}
 }
 
 // End
@@ -23,6 +23,7 @@
 #define __GRID__H
 
 #include "Box.h"
+#include "Utils/Bits.h"
 
 
 // ===========================================================================
@@ -50,6 +51,14 @@ public:
 		int right, top;
 	};
 
+	/// Vertical slot crossing a box
+	struct Crossing
+	{
+		int start;		///< Slot location in the column-major letters (-1: no slot)
+		int offset;		///< Box offset in the slot
+		int length;		///< Slot length
+	};
+
 public :
 
 	/// Type of block density allowed in this grid
@@ -62,6 +71,7 @@ public :
 	const Box* operator () (int x, int y) const;
 
 	void Grow (uint8_t sx, uint8_t sy);
+	void Copy (const Grid& grid);
 	void Erase ();
 	void LockContent ();
 	void Unlock ();
@@ -73,6 +83,7 @@ public :
 	int GetNumBlackCases () const {return numBlackCases;}
 	int GetNumVoidBoxes () const { return numVoidBoxes; }
 	int GetFillRate () const;
+	bool FindFreeBox (uint8_t *px, uint8_t *py) const;
 
 	void AddBloc (uint8_t x, uint8_t y);
 	void RemoveBloc (uint8_t x, uint8_t y);
@@ -81,18 +92,50 @@ public :
 	void FailAtColumn (uint8_t x, uint8_t y);
     
 	bool CheckBlocDensity (uint8_t x, uint8_t y) const;
+	bool CheckBlocDensityBoxes (uint8_t x, uint8_t y) const;
 	unsigned char BuildMask (uint8_t mask [], uint8_t x, uint8_t y, char dir, bool goBack) const;	
 	Space GetSpace (int x, int y) const;
 
+	void TrackColumns (bool state);
+	uint8_t* GetColumnMask (int x, int y, int& offset, int& length);
+
+private :
+
+	/// Unchecked access to a box. The sentinel border makes (-1..width, -1..height) valid.
+	Box* BoxAt (int x, int y) { return &mpTabCases [(y+1)*mStride + x+1]; }
+	const Box* BoxAt (int x, int y) const { return &mpTabCases [(y+1)*mStride + x+1]; }
+
+	/// Column-major letter of a box. A null sentinel makes (x, -1..height) valid.
+	uint8_t* ColumnAt (int x, int y) { return &mpColumns [x*(mSy+2) + y+1]; }
+	const uint8_t* ColumnAt (int x, int y) const { return &mpColumns [x*(mSy+2) + y+1]; }
+
+	void SyncContent ();
+	void SyncBox (int x, int y);
+
+	uint64_t GetBlocBits (const uint64_t* board, int x, int y, int n) const;
+	void SetBlocBit (uint64_t* board, int x, int y, bool state);
+	void BuildCrossings ();
+
 private :
 				
 
 	int mSx, mSy;						///< Grid dimensions
-	Box *mpTabCases;					///< Array of boxes
+	int mStride;						///< Row length in the boxes array (grid width plus the border)
+	Box *mpTabCases;					///< Array of boxes, surrounded by a sentinel border
+	uint8_t *mpColumns;					///< Column-major copy of the letters ('*': empty, 0: black, void or column end)
 	
 	enum BlocDensityMode densityMode;	///< Allowed bloc density
 	int numBlackCases;					///< Total number of black boxes
 	int numVoidBoxes;					///< Total number of void boxes
+	int numFreeBoxes;					///< Total number of empty letter boxes
+	uint64_t* freeBoxes;				///< Empty letter boxes bitset, in row-major order
+
+	// Black boxes bitboards, one row of 'mBoardStride' words per grid row, border included
+	int mBoardStride;					///< Number of 64 bits words per bitboard row
+	uint64_t* blocBoard;				///< Black boxes, along with the grid border
+	uint64_t* freeBlocBoard;			///< Unlocked black boxes
+
+	Crossing* crossings;				///< Vertical slot crossing each box, when tracked
 };
 
 
@@ -25,6 +25,27 @@
 #include "libWizium.h"
 #include "Grid/Grid.h"
 #include "Dictionary/Dictionary.h"
+#include "Dictionary/MaskCache.h"
+#include "Utils/Random.h"
+#include <string.h>
+#include <chrono>
+
+
+// ===========================================================================
+// D E F I N E S
+// ===========================================================================
+
+/// Set to 0 to compile the solvers without their statistics counters
+#ifndef WIZIUM_STATS
+#define WIZIUM_STATS 1
+#endif
+
+/// Statement only compiled with the statistics counters
+#if WIZIUM_STATS
+#define STAT(x) x
+#else
+#define STAT(x)
+#endif
 
 
 // ###########################################################################
@@ -37,7 +58,7 @@ class ISolver
 {
 public:
 
-	ISolver() : pGrid (nullptr), pDict (nullptr), seed (0), mSx (0), mSy (0), steps (0) {}
+	ISolver() : pGrid (nullptr), pDict (nullptr), seed (0), mSx (0), mSy (0), steps (0) { ResetStats (); }
 	virtual ~ISolver() {}
 
 	virtual void Solve_Start (Grid &grid, const Dictionary &dico) = 0;
@@ -47,18 +68,94 @@ public:
 	virtual void SetHeurestic (bool state, int param) = 0;
 	virtual void SetSeed (uint64_t seed) {this->seed = seed;}
 
+	/// Generation failed: solvers drop their dictionary when there is no solution
+	bool HasFailed () const { return pGrid != nullptr && pDict == nullptr; }
+
+	virtual SolverStats GetStats () const;
+	void ResetStats ();
+	void MergeStats (const SolverStats& other) { AddStats (stats, other); }
+	static void AddStats (SolverStats& total, const SolverStats& other);
+
 protected:
 
+	void CountBacktrack (uint64_t numRemoved);
+	static uint64_t ElapsedNs (std::chrono::steady_clock::time_point start);
+
 	
 	Grid *pGrid;				///< Grid to solve
 	const Dictionary *pDict;	///< Dictionary to use
 
 	uint64_t seed;		///< Seed for the random generator	
+	Random rng;			///< Random generator, private to this solver
 	uint8_t mSx, mSy;	///< Grid size
 	uint64_t steps;		///< Number of steps during the generation
+
+	MaskCache maskCache;	///< Remembers which masks match some dictionary word
+	SolverStats stats;		///< Statistics counters (mask cache ones are only added when the cache is attached again)
 };
 
 
+// ===========================================================================
+/// \brief		Return the statistics counters since the last reset
+// ===========================================================================
+inline SolverStats ISolver::GetStats () const
+{
+	SolverStats result = stats;
+	STAT (result.cacheHits += maskCache.GetHits ());
+	STAT (result.cacheMisses += maskCache.GetMisses ());
+	return result;
+}
+
+
+// ===========================================================================
+/// \brief		Reset the statistics counters
+// ===========================================================================
+inline void ISolver::ResetStats ()
+{
+	memset (&stats, 0, sizeof (stats));
+	maskCache.ResetCounters ();
+}
+
+
+// ===========================================================================
+/// \brief		Add statistics counters to others
+///
+/// \param		total		Counters to update
+/// \param		other		Counters to add
+// ===========================================================================
+inline void ISolver::AddStats (SolverStats& total, const SolverStats& other)
+{
+	uint64_t* pDst = reinterpret_cast<uint64_t*> (&total);
+	const uint64_t* pSrc = reinterpret_cast<const uint64_t*> (&other);
+	for (size_t i = 0; i < sizeof (SolverStats) / sizeof (uint64_t); i ++) pDst [i] += pSrc [i];
+}
+
+
+// ===========================================================================
+/// \brief		Count a backtrack event
+///
+/// \param		numRemoved		Number of words removed from the grid
+// ===========================================================================
+inline void ISolver::CountBacktrack (uint64_t numRemoved)
+{
+	int bin = 0;
+	while (bin < 7 && numRemoved > (1ULL << bin)) bin ++;
+
+	stats.backtracks ++;
+	stats.backtrackDepth [bin] ++;
+}
+
+
+// ===========================================================================
+/// \brief		Return the time elapsed since a given instant [ns]
+// ===========================================================================
+inline uint64_t ISolver::ElapsedNs (std::chrono::steady_clock::time_point start)
+{
+	auto duration = std::chrono::steady_clock::now () - start;
+	return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count ();
+}
+
+
 #endif
 
 
@@ -86,7 +86,12 @@ void SolverDynamic::Solve_Start (Grid &grid, const Dictionary &dico)
 
 	// Init step counter and rng
 	this->steps = 0;
-	srand (static_cast<uint32_t> (this->seed));
+	rng.Seed (this->seed);
+
+	// Cached mask answers are only valid for this dictionary content
+	STAT (stats.cacheHits += maskCache.GetHits ());
+	STAT (stats.cacheMisses += maskCache.GetMisses ());
+	maskCache.Attach (&dico);
 }
 
 
@@ -131,11 +136,13 @@ Status SolverDynamic::Solve_Step (int32_t maxTimeMs, int32_t maxSteps)
 		return status;
 	}
 
+	STAT (auto stepStart = std::chrono::steady_clock::now ());
+
 	// Processing loop
 	while (true)
 	{
 		// Find out the next empty box to consider
-		if (FindFreeBox (&x, &y) == false)
+		if (pGrid->FindFreeBox (&x, &y) == false)
 		{
 			FreeItems ();
 			break;
@@ -209,6 +216,8 @@ Status SolverDynamic::Solve_Step (int32_t maxTimeMs, int32_t maxSteps)
 		}
 	}
 
+	STAT (stats.stepTimeNs += ElapsedNs (stepStart));
+
 	status.counter = this->steps;
 	status.fillRate = pGrid ? pGrid->GetFillRate () : 0;
 	return status;
@@ -253,6 +262,9 @@ SolverDynamic::DynamicItem* SolverDynamic::Backtrack (int valRow, int valCol)
 	bool changeLength;
 	int targetCol = -1;
 
+	STAT (auto backtrackStart = std::chrono::steady_clock::now ());
+	STAT (uint64_t removedBefore = stats.removedWords);
+
 	// Remove items from backtrack list until we can change one successfuly
 	while (pItem == nullptr)
 	{
@@ -263,6 +275,7 @@ SolverDynamic::DynamicItem* SolverDynamic::Backtrack (int valRow, int valCol)
 			pItem = GetLastItem ();
 			if (pItem == nullptr) break;
 			pItem->RemoveFromGrid (*this->pGrid);
+			STAT (stats.removedWords ++);
 
 			changeLength = false;
 			targetCol = -1;
@@ -325,6 +338,8 @@ SolverDynamic::DynamicItem* SolverDynamic::Backtrack (int valRow, int valCol)
 		}
 	}
 
+	STAT (CountBacktrack (stats.removedWords - removedBefore));
+	STAT (stats.backtrackTimeNs += ElapsedNs (backtrackStart));
 	return pItem;
 }
 
@@ -410,13 +425,17 @@ bool SolverDynamic::ChangeItem (DynamicItem *pItem, bool changeLength, int colTo
 			mask [pItem->length] = 0;
 
 			// Try to find something matching the constraints
+			STAT (auto fillStart = std::chrono::steady_clock::now ());
 			bool result = ChangeItemWord (pItem, mask, unvalidatedIdx);
 			unvalidatedIdx = -1;
+			STAT (stats.fillTimeNs += ElapsedNs (fillStart));
 
 			// If a word is found, cross check every letter. 'bestPos' memorize how far we went.
 			if (result)
 			{
+				STAT (auto crossStart = std::chrono::steady_clock::now ());
 				result = CheckItemCross (pItem, &pItem->bestPos);
+				STAT (stats.crossTimeNs += ElapsedNs (crossStart));
 				if (result) step = DONE;
 			}
 			// Otherwise this length has been dried out
@@ -494,15 +513,16 @@ bool SolverDynamic::ChangeItemWord (DynamicItem *pItem, uint8_t mask [], int unv
 		// If it is the first time we try, choose begining at random
 		if (pItem->word [0] == 0)
 		{
-			pItem->word [0] = 1 + rand () % pDict->AlphabetSize ();
-			pItem->word [1] = 1 + rand () % pDict->AlphabetSize ();
-			pItem->word [2] = 1 + rand () % pDict->AlphabetSize ();
+			pItem->word [0] = 1 + rng.Below (pDict->AlphabetSize ());
+			pItem->word [1] = 1 + rng.Below (pDict->AlphabetSize ());
+			pItem->word [2] = 1 + rng.Below (pDict->AlphabetSize ());
 			pItem->word [3] = 0;
 			pItem->word [pItem->length] = 0;
 		}
 
 		// Look for something in the dictionary
 		bool found = pDict->FindEntry (pItem->word, mask, pItem->word, pItem->candidates);
+		STAT (stats.fillSearches ++);
 
 		// If nothing found, restart at the begining of the dictionary
 		// (can only be done once)
@@ -513,6 +533,7 @@ bool SolverDynamic::ChangeItemWord (DynamicItem *pItem, uint8_t mask [], int unv
 
 			pItem->word [0] = 0;
 			found = pDict->FindEntry (pItem->word, mask, pItem->word, pItem->candidates);
+			STAT (stats.fillSearches ++);
 		}
 
 		// Could not find anything ?
@@ -586,7 +607,6 @@ Grid::Space SolverDynamic::CheckGridBlock (int x, int y)
 	int i;
 	int back;								///< Where does the mask start (relative to x, y)
 	uint8_t mask [MAX_GRID_SIZE + 1];		///< Buffer to extract the grid content
-	uint8_t word [MAX_GRID_SIZE + 1];		///< Buffer to extract word possibility
 
 	// Out of grid and not on the direct border ?
 	if (x > mSx || x < -1) return space;
@@ -643,7 +663,8 @@ Grid::Space SolverDynamic::CheckGridBlock (int x, int y)
 			if ((back - i) <= 1) break;
 
 			// Look for a word starting in 'i' and complying with the mask
-			if (pDict->FindEntry (word, mask + i) == true) break;
+			STAT (stats.blockProbes ++);
+			if (maskCache.Exists (mask + i) == true) break;
 		}
 
 		// - Remove block in (x,y)
@@ -664,7 +685,8 @@ Grid::Space SolverDynamic::CheckGridBlock (int x, int y)
 
 			// Write a block in 'i' and look for something
 			mask [i] = 0;
-			if (pDict->FindEntry (word, mask + back + 1) == true) break;
+			STAT (stats.blockProbes ++);
+			if (maskCache.Exists (mask + back + 1) == true) break;
 		}
 
 		// - Write result
@@ -689,7 +711,7 @@ int SolverDynamic::GetInitialLength (int row, int maxLength)
 	if (row < 2)
 	{
 		if (maxLength > 8) maxLength = 8;
-		int l = rand () % (maxLength);
+		int l = rng.Below (maxLength);
 		return l + 1;
 	}
 	else return maxLength;
@@ -707,7 +729,6 @@ int SolverDynamic::GetInitialLength (int row, int maxLength)
 bool SolverDynamic::CheckItemCross (DynamicItem *pItem, int *pBestPos)
 {
 	uint8_t mask [MAX_GRID_SIZE + 1];
-	uint8_t word [MAX_GRID_SIZE + 1];
 
 	// Check every letter in order
 	for (int i = 0; i < pItem->length; i ++)
@@ -744,13 +765,20 @@ bool SolverDynamic::CheckItemCross (DynamicItem *pItem, int *pBestPos)
 
 			// Ensure it is possible to put a back box in 'j+1'
 			if (j + 1 < length)
-				if (pGrid->CheckBlocDensity (x, y + j + 1) == false) continue;
+			{
+				if (pGrid->CheckBlocDensity (x, y + j + 1) == false)
+				{
+					STAT (stats.densityRejections ++);
+					continue;
+				}
+			}
 
 			// Truncate the mask to simulate the black box
 			mask [j + 1] = 0;
 
 			// Can we find somehting in the dictionary ?
-			if (pDict->FindEntry (word, mask) == true) break;
+			STAT (stats.crossChecks ++);
+			if (maskCache.Exists (mask) == true) break;
 		}
 
 		// Failed ?
@@ -790,7 +818,11 @@ bool SolverDynamic::CheckItemLength (const DynamicItem *pItem)
 	if (maxBlackCases == 0) return false;
 
 	// Check about local density
-	if (pGrid->CheckBlocDensity (x, y) == false) return false;
+	if (pGrid->CheckBlocDensity (x, y) == false)
+	{
+		STAT (stats.densityRejections ++);
+		return false;
+	}
 
 	// Check about global density
 	if (this->maxBlackCases >= 0)
@@ -856,38 +888,6 @@ void SolverDynamic::FreeItems ()
 }
 
 
-// ===========================================================================
-/// \brief	Find the first grid free box
-///
-/// \param	px, py		Coordinates of the box
-/// \return	True in case of success
-// ===========================================================================
-bool SolverDynamic::FindFreeBox (uint8_t *px, uint8_t *py) const
-{
-	uint8_t x, y;
-	const Box *box = nullptr;
-
-	// Look from left to right, then from top to bottom
-	for (y = 0; y < mSy; y ++)
-	{
-		for (x = 0; x < mSx; x ++)
-		{
-			box = pGrid->operator ()(x, y);
-			if (box->IsLetter () && box->GetLetter () == 0) break;
-		}
-
-		if (x < mSx) break;
-	}
-
-	// Found nothing ?
-	if (y >= mSy) return false;
-
-	if (px != nullptr) *px = x;
-	if (py != nullptr) *py = y;
-	return true;
-}
-
-
 // ===========================================================================
 /// \brief	Push a word in the list where we keep all the unused words
 ///	This mechanism avoid frequent new/delete operations
@@ -65,7 +65,6 @@ private:
 	bool CheckItemLength (const DynamicItem *pItem);
 
 	void FreeItems ();
-	bool FindFreeBox (uint8_t *px, uint8_t *py) const;
 
 	void PushUnusedItem (DynamicItem* pItem);
 	DynamicItem* PopUnusedItem ();
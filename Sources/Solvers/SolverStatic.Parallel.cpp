@@ -0,0 +1,338 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		SolverStatic.Parallel.cpp
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Parallel exploration of the static solver search tree
+// ###########################################################################
+
+#include <chrono>
+#include <thread>
+
+#include "Solvers/SolverStatic.Parallel.h"
+#include "Solvers/SolverStatic.StaticItem.h"
+
+
+// ===========================================================================
+// D E F I N E S
+// ===========================================================================
+
+/// Max time a worker runs before checking if another one has already won [ms]
+constexpr auto PARALLEL_SLICE_MS = 5;
+
+
+// ###########################################################################
+//
+// P U B L I C
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief		Constructor. Build the sub problems and deal them to the workers.
+///
+/// \param		owner		Solver we work for. It must be started (word list built)
+/// \param		numThreads	Number of workers
+// ===========================================================================
+SolverStatic::Parallel::Parallel (SolverStatic& owner, int numThreads) : owner (owner), winner (-1)
+{
+	base.Copy (*owner.pGrid);
+
+	numWorkers = numThreads;
+	workers = new Worker [numWorkers];
+	numWords = BuildSubProblems ();
+
+	for (int i = 0; i < numWorkers; i ++)
+	{
+		Worker& worker = workers [i];
+
+		worker.solver.SetSeed (owner.seed + i + 1);
+		worker.solver.SetHeurestic (owner.heurestic, owner.stepBack);
+		worker.solver.SetDynamicOrder (owner.dynamicOrder);
+		worker.solver.SetPropagation (owner.propagation);
+		worker.solver.SetNoGoods (owner.noGoodsSize);
+
+		// Round robin distribution of the sub problems
+		worker.tasks = new int [numWords / numWorkers + 1];
+		worker.front = worker.back = 0;
+		for (int t = i; t < numWords; t += numWorkers) worker.tasks [worker.back ++] = t;
+
+		worker.busy = false;
+		worker.steps = 0;
+		worker.status.counter = 0;
+		worker.status.fillRate = 0;
+	}
+}
+
+
+// ===========================================================================
+/// \brief		Destructor
+// ===========================================================================
+SolverStatic::Parallel::~Parallel ()
+{
+	for (int i = 0; i < numWorkers; i ++) delete [] workers [i].tasks;
+	delete [] workers;
+	delete [] words;
+}
+
+
+// ===========================================================================
+/// \brief	Let the workers explore the sub problems for some time.
+///
+/// \param		maxTimeMs:		>=0: Maximum time to spend [ms] before returning.
+///								-1: No stop criteria
+/// \param		maxSteps:		>=0: Maximum word tries of each worker before returning
+///								-1: No stop criteria
+///
+/// \return		Generation status. The counter is the sum of all the workers counters.
+// ===========================================================================
+Status SolverStatic::Parallel::Step (int32_t maxTimeMs, int32_t maxSteps)
+{
+	Status status;
+	int best = -1;
+	int remaining = 0;
+
+	// One thread per worker
+	if (winner < 0)
+	{
+		std::thread* threads = new std::thread [numWorkers];
+		for (int i = 0; i < numWorkers; i ++) 
+			threads [i] = std::thread (&Parallel::Run, this, i, maxTimeMs, maxSteps);
+		for (int i = 0; i < numWorkers; i ++) 
+			threads [i].join ();
+		delete [] threads;
+	}
+
+	// Gather results
+	status.counter = 0;
+	for (int i = 0; i < numWorkers; i ++)
+	{
+		Worker& worker = workers [i];
+
+		status.counter += worker.steps;
+		remaining += worker.back - worker.front;
+		if (worker.busy == false) continue;
+
+		status.counter += worker.status.counter;
+		if (best < 0 || worker.status.fillRate > workers [best].status.fillRate) best = i;
+	}
+
+	if (winner >= 0) best = winner;
+
+	// Show the solution or the most advanced worker
+	if (best >= 0)
+	{
+		owner.pGrid->Copy (workers [best].grid);
+		status.fillRate = workers [best].status.fillRate;
+	}
+
+	// Every sub problem failed
+	else if (remaining == 0)
+	{
+		owner.pGrid->Copy (base);
+		owner.pGrid->Erase ();
+		owner.pDict = nullptr;
+		status.fillRate = 0;
+	}
+	else status.fillRate = base.GetFillRate ();
+
+	return status;
+}
+
+
+// ===========================================================================
+/// \brief		Add the statistics counters of all the workers
+///
+/// \param		stats		Counters to update
+// ===========================================================================
+void SolverStatic::Parallel::AddStats (SolverStats& stats) const
+{
+	for (int i = 0; i < numWorkers; i ++) ISolver::AddStats (stats, workers [i].solver.GetStats ());
+}
+
+
+
+// ###########################################################################
+//
+// P R I V A T E
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief		Enumerate the words fitting the first slot of the owner list,
+///				in a random order.
+///
+/// \return		Number of words, i.e. number of sub problems
+// ===========================================================================
+int SolverStatic::Parallel::BuildSubProblems ()
+{
+	uint8_t mask [MAX_GRID_SIZE + 1];
+	const StaticItem& item = owner.items [owner.order [0]];
+	const Dictionary& dico = *owner.pDict;
+
+	base.BuildMask (mask, item.posX, item.posY, 'H', false);
+	int count = dico.CountMatches (mask);
+
+	words = new uint8_t [count > 0 ? count : 1][MAX_WORD_LENGTH + 1];
+	int n = 0;
+	while (n < count && dico.FindEntry (words [n], mask, n > 0 ? words [n-1] : nullptr)) n ++;
+
+	// Shuffle, to keep the randomness of the sequential solver
+	for (int i = n - 1; i > 0; i --)
+	{
+		int j = static_cast<int> (owner.rng.Below (i + 1));
+		for (int k = 0; k <= item.length; k ++)
+		{
+			uint8_t c = words [i][k];
+			words [i][k] = words [j][k];
+			words [j][k] = c;
+		}
+	}
+
+	return n;
+}
+
+
+// ===========================================================================
+/// \brief		Get the next sub problem for a worker. Take it from its own queue
+///				or steal it from another worker if empty.
+///
+/// \param		idx			Worker index
+/// \param[out]	pTask		Sub problem to solve
+///
+/// \return		False if there is nothing left
+// ===========================================================================
+bool SolverStatic::Parallel::PopTask (int idx, int* pTask)
+{
+	// Own queue first
+	{
+		Worker& worker = workers [idx];
+		std::lock_guard<std::mutex> guard (worker.lock);
+		if (worker.front < worker.back)
+		{
+			*pTask = worker.tasks [worker.front ++];
+			return true;
+		}
+	}
+
+	// Then steal from the other ones
+	for (int i = 1; i < numWorkers; i ++)
+	{
+		Worker& victim = workers [(idx + i) % numWorkers];
+		std::lock_guard<std::mutex> guard (victim.lock);
+		if (victim.front < victim.back)
+		{
+			*pTask = victim.tasks [-- victim.back];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// ===========================================================================
+/// \brief		Prepare a worker grid for a sub problem and start its solver
+///
+/// \param		worker		Target worker
+/// \param		task		Sub problem
+// ===========================================================================
+void SolverStatic::Parallel::StartTask (Worker& worker, int task)
+{
+	const StaticItem& item = owner.items [owner.order [0]];
+
+	// Fix the first slot word. Solver start will lock it.
+	worker.grid.Copy (base);
+	for (int i = 0; i < item.length; i ++)
+		worker.grid (item.posX + i, item.posY)->SetLetter (words [task][i]);
+
+	worker.solver.Solve_Start (worker.grid, *owner.pDict);
+	worker.busy = true;
+	worker.status.counter = 0;
+	worker.status.fillRate = 0;
+}
+
+
+// ===========================================================================
+/// \brief		Thread body of one worker. Solve sub problems by slices, until time 
+///				or steps are exhausted, there is nothing left or some worker has won.
+///
+/// \param		idx				Worker index
+/// \param		maxTimeMs:		>=0: Maximum time to spend [ms] before returning.
+///								-1: No stop criteria
+/// \param		maxSteps:		>=0: Maximum word tries before returning
+///								-1: No stop criteria
+// ===========================================================================
+void SolverStatic::Parallel::Run (int idx, int32_t maxTimeMs, int32_t maxSteps)
+{
+	Worker& worker = workers [idx];
+	uint64_t initCounter = worker.steps + worker.status.counter;
+	auto start = std::chrono::steady_clock::now ();
+	bool stepped = false;
+
+	while (winner < 0)
+	{
+		// Size the next slice according to the remaining budget. Like the sequential
+		// solver, run at least one slice per call, even with no budget
+		int32_t sliceMs = PARALLEL_SLICE_MS;
+		int32_t sliceSteps = -1;
+
+		if (maxTimeMs >= 0)
+		{
+			auto elapsed = std::chrono::steady_clock::now () - start;
+			int64_t remaining = maxTimeMs - std::chrono::duration_cast<std::chrono::milliseconds> (elapsed).count ();
+			if (remaining <= 0 && stepped) break;
+			if (remaining < sliceMs) sliceMs = static_cast<int32_t> (remaining > 0 ? remaining : 0);
+		}
+		if (maxSteps >= 0)
+		{
+			int64_t remaining = maxSteps - static_cast<int64_t> (worker.steps + worker.status.counter - initCounter);
+			if (remaining <= 0 && stepped) break;
+			sliceSteps = static_cast<int32_t> (remaining > 0 ? remaining : 0);
+		}
+
+		// Get a new sub problem if needed. It is always run right after, so that
+		// a busy worker always has a status to show
+		int task;
+		if (worker.busy == false)
+		{
+			if (PopTask (idx, &task) == false) break;
+			StartTask (worker, task);
+		}
+
+		worker.status = worker.solver.Solve_Step (sliceMs, sliceSteps);
+		stepped = true;
+
+		// Success: we are the winner if nobody was faster
+		if (worker.status.fillRate == 100)
+		{
+			int none = -1;
+			winner.compare_exchange_strong (none, idx);
+			break;
+		}
+
+		// This sub problem has no solution
+		if (worker.solver.HasFailed ())
+		{
+			worker.steps += worker.status.counter;
+			worker.status.counter = 0;
+			worker.busy = false;
+		}
+	}
+}
+
+// End
@@ -0,0 +1,93 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		SolverStatic.Parallel.h
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Parallel exploration of the static solver search tree
+// ###########################################################################
+
+#ifndef __CSOLVERSTAT_PARALLEL__H
+#define __CSOLVERSTAT_PARALLEL__H
+
+#include <atomic>
+#include <mutex>
+#include "Grid/Grid.h"
+#include "Dictionary/Dictionary.h"
+#include "Solvers/SolverStatic.h"
+
+
+// ###########################################################################
+//
+// P R O T O T Y P E S
+//
+// ###########################################################################
+
+/// Split of the search tree at the first slot: each word that fits this slot
+/// defines a sub problem. Sub problems are dealt to a set of workers, each one
+/// with its own grid and its own single threaded solver. A worker running out of
+/// sub problems steals the ones left by the others. The first complete grid wins.
+class SolverStatic::Parallel
+{
+public:
+
+	Parallel (SolverStatic& owner, int numThreads);
+	~Parallel ();
+
+	Parallel (const Parallel&) = delete;
+	Parallel& operator = (const Parallel&) = delete;
+
+	Status Step (int32_t maxTimeMs, int32_t maxSteps);
+	void AddStats (SolverStats& stats) const;
+
+private:
+
+	/// Worker thread context
+	struct Worker
+	{
+		Grid grid;					///< Grid of the sub problem
+		SolverStatic solver;		///< Solver of the sub problem
+
+		std::mutex lock;			///< Protects the sub problem queue
+		int* tasks;					///< Queue of sub problems (index of their first word)
+		int front, back;			///< Queue range. The owner pops at the front, thieves at the back
+
+		bool busy;					///< A sub problem is in progress
+		uint64_t steps;				///< Steps of the finished sub problems
+		Status status;				///< Status of the sub problem in progress
+	};
+
+	int BuildSubProblems ();
+	bool PopTask (int idx, int* pTask);
+	void StartTask (Worker& worker, int task);
+	void Run (int idx, int32_t maxTimeMs, int32_t maxSteps);
+
+private:
+
+	SolverStatic& owner;			///< Solver we work for
+	Grid base;						///< Grid to solve, as given at start
+
+	int numWorkers;					///< Number of workers (one thread each)
+	Worker* workers;				///< Workers
+
+	uint8_t (*words) [MAX_WORD_LENGTH + 1];		///< Words fitting the first slot (one per sub problem)
+	int numWords;								///< Number of sub problems
+
+	std::atomic<int> winner;		///< Index of the worker that completed the grid, -1 if none
+};
+
+#endif
@@ -40,6 +40,9 @@ SolverStatic::StaticItem::StaticItem ()
 	prevWord [0] = 0;
 	firstWord [0] = 0;
 
+	possibleLetters = nullptr;
+	crossTestedCandidates = nullptr;
+
 	processOrder = -1;
 	connectionStrength = 0;
 
@@ -47,6 +50,9 @@ SolverStatic::StaticItem::StaticItem ()
 	posX = 0;
 	posY = 0;
 	bestPos = -1;
+	noGoodRejects = false;
+	numMatches = -1;
+	trailMark = 0;
 }
 
 
@@ -66,6 +72,22 @@ void SolverStatic::StaticItem::Reset ()
 	word [0] = 0;
 	prevWord [0] = 0;
 	firstWord [0] = 0;
+	noGoodRejects = false;
+	ResetCrossCandidates ();
+}
+
+
+// ===========================================================================
+/// \brief		Give this element its letter candidates storage
+///
+/// \param		pool	Storage for (2 x length) candidates
+// ===========================================================================
+void SolverStatic::StaticItem::Attach (LetterCandidates* pool)
+{
+	possibleLetters = pool;
+	crossTestedCandidates = pool + length;
+
+	ResetCandidates ();
 	ResetCrossCandidates ();
 }
 
@@ -76,7 +98,7 @@ void SolverStatic::StaticItem::Reset ()
 void SolverStatic::StaticItem::ResetCandidates ()
 {
 	// All letter boxes in the slot become valid candidates
-	for (int i = 0; i < MAX_GRID_SIZE; i++) {
+	for (int i = 0; i < length; i++) {
 		possibleLetters [i].Reset (true);
 	}
 }
@@ -93,7 +115,7 @@ void SolverStatic::StaticItem::SetCandidate (int pos, uint8_t c, bool state)
 {
 	assert (c > 0);
 
-	if (pos < 0 || pos >= MAX_GRID_SIZE) return;
+	if (pos < 0 || pos >= length) return;
 	possibleLetters [pos].Set (c-1, state);
 }
 
@@ -108,7 +130,7 @@ bool SolverStatic::StaticItem::IsCandidate (int pos, uint8_t c)
 {
 	assert (c > 0);
 
-	if (pos < 0 || pos >= MAX_GRID_SIZE) return false;
+	if (pos < 0 || pos >= length) return false;
 	return possibleLetters [pos].Query (c-1);
 }
 
@@ -118,7 +140,7 @@ bool SolverStatic::StaticItem::IsCandidate (int pos, uint8_t c)
 void SolverStatic::StaticItem::ResetCrossCandidates ()
 {
 	// Non any letter boxes in the slot have been cross tested
-	for (int i = 0; i < MAX_GRID_SIZE; i++) {
+	for (int i = 0; i < length; i++) {
 		crossTestedCandidates [i].Reset (false);
 	}
 }
@@ -130,7 +152,7 @@ void SolverStatic::StaticItem::SetCrossCandidate (int pos, uint8_t c, bool state
 {
 	assert (c > 0);
 
-	if (pos < 0 || pos >= MAX_GRID_SIZE) return;
+	if (pos < 0 || pos >= length) return;
 	crossTestedCandidates [pos].Set (c-1, state);
 }
 
@@ -141,7 +163,7 @@ bool SolverStatic::StaticItem::IsCrossTested (int pos, uint8_t c)
 {
 	assert (c > 0);
 
-	if (pos < 0 || pos >= MAX_GRID_SIZE) return false;
+	if (pos < 0 || pos >= length) return false;
 	return crossTestedCandidates [pos].Query (c-1);
 }
 
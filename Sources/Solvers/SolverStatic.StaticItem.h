@@ -42,6 +42,7 @@ public:
 	~StaticItem ();
 
 	void Reset ();
+	void Attach (LetterCandidates* pool);
 
 	void ResetCrossCandidates ();
 	void SetCrossCandidate (int pos, uint8_t c, bool state);
@@ -58,12 +59,17 @@ public:
 	uint8_t prevWord [MAX_WORD_LENGTH + 1];		///< Previous word we could successfully put on the grid	
 	uint8_t firstWord [MAX_WORD_LENGTH + 1];	///< First word when we start searching a new value, to detect we went around the dictionary
 	
-	LetterCandidates possibleLetters[MAX_GRID_SIZE];		///< Letter candidates for each item box
-	LetterCandidates crossTestedCandidates[MAX_GRID_SIZE];	///< Cross-tested letters for each item box
+	LetterCandidates* possibleLetters;			///< Letter candidates for each item box ('length' entries in the solver pool)
+	LetterCandidates* crossTestedCandidates;	///< Cross-tested letters for each item box ('length' entries in the solver pool)
 
 	// Dynamic info used to backtrack
 	int bestPos;					///< Best letter we could cross validate, in case of failure when searching a word.
 	bool visibility;				///< Is this word visible to any following word impacted by a failure
+	bool noGoodRejects;				///< A nogood rejected some of the words tried since the last reset
+
+	// Dynamic info used to order the items
+	int numMatches;					///< Words fitting the slot and its crosswords (capped), -1 if it must be computed again
+	int trailMark;					///< Propagation trail length when the word has been placed
 
 	// Static info set once before solving
 	int connectionStrength;			///< How much this word connects with previous words in the resolution list
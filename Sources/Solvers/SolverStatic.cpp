@@ -27,7 +27,19 @@
 
 #include "SolverStatic.h"
 #include "SolverStatic.StaticItem.h"
+#include "SolverStatic.Parallel.h"
 #include "Dictionary/Dictionary.h"
+#include "Utils/Bits.h"
+
+
+// ===========================================================================
+// D E F I N E
+// ===========================================================================
+
+/// Match counts used to pick the next slot (dynamic order) stop at this value.
+/// Slots with more words than that are considered unconstrained and taken in the static order.
+#define ORDER_MATCH_LIMIT	32
+
 
 // ###########################################################################
 //
@@ -42,11 +54,39 @@ SolverStatic::SolverStatic ()
 {
 	seed = 0;
 	items = nullptr;
+	candidates = nullptr;
 	numItems = -1;		
 	idxCurrentItem = -1;
+	order = nullptr;
 
 	heurestic = true;
 	stepBack = 0;
+	dynamicOrder = false;
+
+	propagation = Propagation::NO_PROPAGATION;
+	itemAt = nullptr;
+	queue = nullptr;
+	queued = nullptr;
+	queueFront = queueLength = 0;
+	trail = nullptr;
+	trailLength = trailSize = 0;
+	boxStamp = nullptr;
+	stamp = 0;
+
+	noGoods = nullptr;
+	noGoodsSize = 0;
+	watches = nullptr;
+	numWatches = nullptr;
+
+	numThreads = 1;
+	parallel = nullptr;
+
+	crossStart = nullptr;
+	crossItem = nullptr;
+	crossMask = nullptr;
+	skeleton = nullptr;
+	skeletonKey = 0;
+	skeletonSx = skeletonSy = 0;
 }
 
 
@@ -55,7 +95,9 @@ SolverStatic::SolverStatic ()
 // ===========================================================================
 SolverStatic::~SolverStatic ()
 {
-	if (items != nullptr) delete [] items;
+	delete parallel;
+	FreeSkeleton ();
+	delete [] noGoods;
 }
 
 
@@ -75,19 +117,50 @@ void SolverStatic::SetHeurestic (bool state, int stepBack)
 }
 
 
+// ===========================================================================
+/// \brief		Set how many nogoods the solver can remember
+///
+/// When a slot has no word left because of the letters its crosswords already hold,
+/// these letters are remembered as a nogood. The words that would put them back on
+/// the grid are then rejected, and the backtracking goes straight back to the last
+/// word that put one of them.
+///
+/// \param	capacity		Number of nogoods (rounded up to a power of 2). 0: none
+// ===========================================================================
+void SolverStatic::SetNoGoods (int capacity)
+{
+	int size = 0;
+	if (capacity > (1 << 20)) capacity = 1 << 20;
+	if (capacity > 0) for (size = 1; size < capacity; size *= 2);
+	if (size == noGoodsSize) return;
+
+	delete [] noGoods;
+	noGoods = (size > 0) ? new NoGood [size] : nullptr;
+	noGoodsSize = size;
+}
+
+
 // ===========================================================================
 /// \brief		Stop searching for a solution
 // ===========================================================================
 void SolverStatic::Solve_Stop ()
 {
 	// Unlock all grid boxes	
-	if (pGrid != nullptr) pGrid->Unlock ();
+	if (pGrid != nullptr)
+	{
+		pGrid->Unlock ();
+		pGrid->TrackColumns (false);
+	}
 
 	this->pDict = nullptr;
 	this->pGrid = nullptr;
 	this->steps = 0;
-	numItems = -1;
 	idxCurrentItem = -1;
+
+	// Keep the statistics of the threads
+	STAT (if (parallel != nullptr) parallel->AddStats (stats));
+	delete parallel;
+	parallel = nullptr;
 }
 
 
@@ -113,14 +186,57 @@ void SolverStatic::Solve_Start (Grid &grid, const Dictionary &dico)
 	// Lock non empty boxes
 	this->pGrid->LockContent ();
 
-	// Establish a static ordered list of word slots for whose we must find a solution
-	if (items != nullptr) delete [] items;
-	BuildWordList ();
-	idxCurrentItem = 0;
+	// Crosswords are checked against the vertical slots masks maintained by the grid
+	this->pGrid->TrackColumns (true);
+
+	// Establish a static ordered list of word slots for whose we must find a solution.
+	// It only depends on the black boxes layout, so it can be reused from a previous solve.
+	if (IsSameSkeleton ())
+	{
+		for (int i = 0; i < numItems; i ++)
+		{
+			items [i].Reset ();
+			items [i].bestPos = -1;
+			items [i].numMatches = -1;
+		}
+	}
+	else
+	{
+		FreeSkeleton ();
+		BuildWordList ();
+		SaveSkeleton ();
+	}
+
+	// Nogoods only hold for the grid content and the dictionary they have been learnt with
+	for (int i = 0; i < noGoodsSize; i ++) noGoods [i].key = 0;
+	for (int i = 0; i < numItems; i ++) numWatches [i] = 0;
 
 	// Init step counter and rng
 	this->steps = 0;
-	srand (static_cast<uint32_t> (this->seed));
+	rng.Seed (this->seed);
+
+	// Cached mask answers are only valid for this dictionary content
+	STAT (stats.cacheHits += maskCache.GetHits ());
+	STAT (stats.cacheMisses += maskCache.GetMisses ());
+	maskCache.Attach (&dico);
+
+	// Narrow the letters of the empty boxes according to the grid content.
+	// A box left without any letter means there is no solution.
+	trailLength = 0;
+	if (propagation != Propagation::NO_PROPAGATION && PropagateAll () == false)
+	{
+		pDict = nullptr;
+		pGrid->Erase ();
+		return;
+	}
+
+	// Start from the static order. In dynamic order, the first slot is the most constrained one
+	for (int i = 0; i < numItems; i ++) order [i] = i;
+	idxCurrentItem = 0;
+	if (dynamicOrder && numItems > 0) SelectNextItem ();
+
+	// Split the search among several threads if requested
+	if (numThreads > 1 && numItems > 0) parallel = new Parallel (*this, numThreads);
 }
 
 
@@ -150,11 +266,21 @@ Status SolverStatic::Solve_Step (int32_t maxTimeMs, int32_t maxSteps)
 		return status;
 	}
 
+	// Parallel search
+	if (parallel != nullptr)
+	{
+		status = parallel->Step (maxTimeMs, maxSteps);
+		this->steps = status.counter;
+		return status;
+	}
+
+	STAT (auto stepStart = std::chrono::steady_clock::now ());
+
 	// Main search loop, we have finished when we have found something for every slots in our list
 	while (this->idxCurrentItem < this->numItems)
 	{		
 		// Get item to solve during this iteration
-		StaticItem *pItem = &items [idxCurrentItem];
+		StaticItem *pItem = &items [order [idxCurrentItem]];
 
 		// Reset 
 		pItem->Reset ();
@@ -195,6 +321,8 @@ Status SolverStatic::Solve_Step (int32_t maxTimeMs, int32_t maxSteps)
 		}
 	}
 		
+	STAT (stats.stepTimeNs += ElapsedNs (stepStart));
+
 	status.counter = this->steps;
 	status.fillRate = pGrid ? pGrid->GetFillRate () : 0;
 	return status;
@@ -202,6 +330,18 @@ Status SolverStatic::Solve_Step (int32_t maxTimeMs, int32_t maxSteps)
 
 
 
+// ===========================================================================
+/// \brief		Return the statistics counters, including those of the threads
+///				taking part in a parallel search
+// ===========================================================================
+SolverStats SolverStatic::GetStats () const
+{
+	SolverStats result = ISolver::GetStats ();
+	if (parallel != nullptr) parallel->AddStats (result);
+	return result;
+}
+
+
 // ###########################################################################
 //
 // P R I V A T E
@@ -216,27 +356,55 @@ void SolverStatic::BackTrack ()
 	unsigned int counter;
 
 	// The first word we change must have direct interaction with the point of failure
-	int targetCol = items [idxCurrentItem].posX + items [idxCurrentItem].bestPos + 1;
+	StaticItem& failing = items [order [idxCurrentItem]];
+	int targetCol = failing.posX + failing.bestPos + 1;
+
+	// In dynamic order, the failing item is often a dead end with no word at all:
+	// any item crossing it may be the cause
+	if (dynamicOrder && failing.bestPos < 0) targetCol = failing.posX + failing.length - 1;
 	int idxTarget = this->idxCurrentItem;
 
+	// With propagation, or when nogoods rejected some of its words, the cause may also
+	// be an item that doesn't cross it (see BackTrackStep): no target.
+	// The heuristic gives up on a complete search anyway, so it keeps backjumping in the latter case
+	bool chronological = propagation != Propagation::NO_PROPAGATION || (failing.noGoodRejects && !heurestic);
+	if (chronological) idxTarget = targetCol = -1;
+
 	// Reset visibility with the failing word
-	for (int i = 0; i < idxCurrentItem; i++) items[i].visibility = false;
-	items [idxCurrentItem].visibility = true;
+	for (int i = 0; i < idxCurrentItem; i++) items [order [i]].visibility = false;
+	failing.visibility = true;
+
+	// If its crosswords alone leave no word to the failing item, the items that put their
+	// letters are the cause (made visible): we can go straight back to the last one
+	int idxJump = -1, jumpCol = -1;
+	bool jump = noGoodsSize > 0 && RecordNoGood (failing, idxJump, jumpCol);
 
 	// Look for the next word to change
 	int idx = this->idxCurrentItem;
 	StaticItem *next = nullptr;
 
+	STAT (auto backtrackStart = std::chrono::steady_clock::now ());
+	STAT (uint64_t removedBefore = stats.removedWords);
+
 	while (next == nullptr)
 	{
 		// Try to backtrack 
-		idx = BackTrackStep (idxTarget, targetCol, idx);
+		if (jump)
+		{
+			while (idx > 0 && idx > idxJump) RemoveItem (-- idx);
+			if (idxJump < 0) idx = -1;
+			else items [order [idx]].visibility = true;
+
+			targetCol = jumpCol;
+			jump = false;
+		}
+		else idx = BackTrackStep (idxTarget, targetCol, idx, chronological);
 		if (idx < 0)
 		{
 			idxCurrentItem = -1;
 			break;
 		}
-		next = &items [idx];
+		next = &items [order [idx]];
 
 		// If no target and heuristic activated, determine the column we force to change
 		if (this->heurestic == true && targetCol == -1)
@@ -269,9 +437,16 @@ void SolverStatic::BackTrack ()
 		SaveCandidatesToGrid (*next);
 
 		// Failed ?
-		if (r == false) next = nullptr;
+		if (r == false)
+		{
+			chronological = propagation != Propagation::NO_PROPAGATION || (next->noGoodRejects && !heurestic);
+			next = nullptr;
+		}
 		else idxCurrentItem = idx;
 	}
+
+	STAT (CountBacktrack (stats.removedWords - removedBefore));
+	STAT (stats.backtrackTimeNs += ElapsedNs (backtrackStart));
 }
 
 
@@ -286,31 +461,36 @@ void SolverStatic::BackTrack ()
 /// \param	targetCol		If 'idxTarget' defined, column that must be visible
 ///							At return, actual value of the column to consider (maybe lesser in case of occlusion)
 /// \param	idx				Current item to start from 
+/// \param	chronological	True to stop at the first item removed
 ///
 /// \return	Index of next item to change
 // ===========================================================================
-int SolverStatic::BackTrackStep (int idxTarget, int& targetCol, int idx)
+int SolverStatic::BackTrackStep (int idxTarget, int& targetCol, int idx, bool chronological)
 {
-	uint8_t mask[MAX_GRID_SIZE + 1];
-	StaticItem *target = (idxTarget >= 0) ? &items[idxTarget] : nullptr;
+	StaticItem *target = (idxTarget >= 0) ? &items [order [idxTarget]] : nullptr;
 
 	// Remove items until we meet our interaction criteria
 	while (--idx >= 0)
 	{
 		// Remove word from grid and prepare to use it
-		pGrid->RemoveWord (items[idx].posX, items[idx].posY, 'H');
-		StaticItem *next = &items[idx];
+		StaticItem *next = &items [order [idx]];
+		RemoveItem (idx);
+
+		// With propagation, a failure can come from any item, through the letters narrowed
+		// in the slots between them. Dependencies don't tell which one: go back chronologically.
+		// The same goes for the words rejected by nogoods
+		if (chronological) break;
 
 		// If we look for strong interaction with a target word
 		if (target != nullptr)
 		{
-			AreDependant (*next, *target, mask);
+			uint64_t mask = AreDependant (order [idx], order [idxTarget]);
 
 			// Strong interaction if any column up to 'targetCol' is visible
 			bool strongInteraction = false;
 			for (int i = targetCol; i >= next->posX; i--)
 			{
-				if (mask[i - next->posX] == '*')
+				if (i - next->posX < 64 && (mask >> (i - next->posX)) & 1)
 				{
 					strongInteraction = true;
 					targetCol = i;
@@ -323,20 +503,48 @@ int SolverStatic::BackTrackStep (int idxTarget, int& targetCol, int idx)
 		// Otherwise, we just seek for weak interaction with any visible item
 		else
 		{
+			// Stop on an item known to be part of the failure cause
+			if (next->visibility) break;
+
 			// Check if 'idx' see any of the following visible items
 			int i;
-			for (i = idx + 1; i <= idxCurrentItem && items [i].visibility; i++)
-				if (AreDependant (*next, items [i], mask)) break;
+			for (i = idx + 1; i <= idxCurrentItem && items [order [i]].visibility; i++)
+				if (AreDependant (order [idx], order [i])) break;
 			if (i <= idxCurrentItem) break;
 		}
 	}
 
 	// Set the visibility flag of the item we have found
-	if (idx >= 0) items [idx].visibility = true;
+	if (idx >= 0) items [order [idx]].visibility = true;
 	return idx;
 }
 
 
+// ===========================================================================
+/// \brief	Remove an item from the grid while backtracking
+///
+/// \param	idx		Item position in the processing order
+// ===========================================================================
+void SolverStatic::RemoveItem (int idx)
+{
+	StaticItem *item = &items [order [idx]];
+	pGrid->RemoveWord (item->posX, item->posY, 'H');
+
+	// The letter candidates narrowed by its placement get their previous value back
+	if (propagation != Propagation::NO_PROPAGATION) RestoreTrail (item->trailMark);
+
+	// In dynamic order, the crossing items can be solved before this one is back:
+	// the candidates its letters led to must go
+	if (dynamicOrder)
+	{
+		item->prevWord [0] = 0;
+		ResetCandidatesAround (*item);
+		InvalidateMatchesAround (order [idx]);
+	}
+	STAT (stats.removedWords ++);
+}
+
+
 // ===========================================================================
 /// \brief	Change the content of an item in the backtracking list.
 ///
@@ -369,14 +577,24 @@ bool SolverStatic::ChangeItem (StaticItem &item, int colToChange, unsigned int*
 
 		// Find a possible word, given the mask and the letter candidates.
 		// We can force a given letter to change
+		STAT (auto fillStart = std::chrono::steady_clock::now ());
 		result = ChangeItemWord (item, mask, unvalidatedIdx, false);
 		unvalidatedIdx = -1;
+		STAT (stats.fillTimeNs += ElapsedNs (fillStart));
 
 		// We found a candidate
 		if (result)
 		{
 			// If a word is found, cross check every letter. 'bestPos' memorize how far we went.
+			STAT (auto crossStart = std::chrono::steady_clock::now ());
 			result = CheckItemCross (item, &item.bestPos);
+			STAT (stats.crossTimeNs += ElapsedNs (crossStart));
+
+			// A word completing a nogood would leave some slot without any word
+			if (result && noGoodsSize > 0) result = CheckNoGoods (item);
+
+			// With propagation, the word is placed to check it leaves some letter to every box
+			if (result && propagation != Propagation::NO_PROPAGATION) result = PlaceItem (item);
 			if (result) break;
 		}
 		else break;
@@ -426,8 +644,9 @@ bool SolverStatic::ChangeItemWord (StaticItem &item, uint8_t mask [], int unvali
 
 		// Look for something in the dictionary
 		// If it is the first time we try, choose begining at random
-		if (item.word [0] == 0) found = pDict->FindRandomEntry (item.word, mask, item.possibleLetters);
+		if (item.word [0] == 0) found = pDict->FindRandomEntry (item.word, mask, rng, item.possibleLetters);
 		else found = pDict->FindEntry (item.word, mask, item.word, item.possibleLetters);
+		STAT (stats.fillSearches ++);
 
 		// If nothing found, restart at the begining of the dictionary
 		// (can only be done once)
@@ -438,6 +657,7 @@ bool SolverStatic::ChangeItemWord (StaticItem &item, uint8_t mask [], int unvali
 
 			item.word [0] = 0;
 			found = pDict->FindEntry (item.word, mask, item.word, item.possibleLetters);
+			STAT (stats.fillSearches ++);
 		}
 
 		// Could not find anything ?
@@ -473,12 +693,15 @@ bool SolverStatic::ChangeItemWord (StaticItem &item, uint8_t mask [], int unvali
 // ===========================================================================
 void SolverStatic::AddCurrentItem ()
 {	
-	// Put the word on the grid
-	StaticItem *pItem = &items [idxCurrentItem];
-	pGrid->AddWord (pItem->posX, pItem->posY, 'H', pItem->word);
-
+	// Put the word on the grid, unless 'ChangeItem' already did it to propagate the candidates.
 	// For each updated letter, reset letter candidates on the cross boxes
-	ResetCandidatesAround (items [idxCurrentItem]);
+	StaticItem *pItem = &items [order [idxCurrentItem]];
+	if (propagation == Propagation::NO_PROPAGATION)
+	{
+		pGrid->AddWord (pItem->posX, pItem->posY, 'H', pItem->word);
+		ResetCandidatesAround (*pItem);
+	}
+	if (dynamicOrder) InvalidateMatchesAround (order [idxCurrentItem]);
 
 	// Save new reference to keep track of updated letters
 	memcpy (pItem->prevWord, pItem->word, pItem->length+1);
@@ -488,6 +711,92 @@ void SolverStatic::AddCurrentItem ()
 
 	// Move on next item in our list, no more failing item
 	idxCurrentItem ++;
+	if (dynamicOrder && idxCurrentItem < numItems) SelectNextItem ();
+}
+
+
+// ===========================================================================
+/// \brief	Dynamic order: bring the most constrained unsolved item at the
+///			current position of the processing order.
+///
+/// The most constrained item is the one with the fewest words fitting both its
+/// mask and its crosswords. Ties, including the items with too many words to be
+/// counted, are broken by the static order.
+// ===========================================================================
+void SolverStatic::SelectNextItem ()
+{
+	int best = idxCurrentItem;
+
+	for (int i = idxCurrentItem; i < numItems; i ++)
+	{
+		StaticItem& item = items [order [i]];
+		if (item.numMatches < 0) item.numMatches = CountItemMatches (item);
+
+		const StaticItem& bestItem = items [order [best]];
+		if (item.numMatches < bestItem.numMatches ||
+			(item.numMatches == bestItem.numMatches && order [i] < order [best])) best = i;
+
+		// Nothing can be more constrained than a dead end
+		if (item.numMatches == 0) break;
+	}
+
+	int swap = order [idxCurrentItem];
+	order [idxCurrentItem] = order [best];
+	order [best] = swap;
+}
+
+
+// ===========================================================================
+/// \brief	Count the words that fit an unsolved item, given its mask, its letter 
+///			candidates and the letters its crosswords allow in each box
+///
+/// \param	item	Target item
+///
+/// \return	Number of words, at most ORDER_MATCH_LIMIT
+// ===========================================================================
+int SolverStatic::CountItemMatches (const StaticItem &item) const
+{
+	uint8_t mask [MAX_GRID_SIZE + 1];
+	LetterCandidates letters [MAX_GRID_SIZE];
+
+	pGrid->BuildMask (mask, item.posX, item.posY, 'H', false);
+
+	for (int i = 0; i < item.length; i ++)
+	{
+		int x = item.posX + i;
+		letters [i] = pGrid->operator ()(x, item.posY)->GetCandidate ();
+		if (mask [i] != '*') continue;
+
+		// Propagated candidates already take the crosswords into account
+		if (propagation != Propagation::NO_PROPAGATION) continue;
+
+		// Only a crossword holding some letters restricts this box
+		int offset, length;
+		const uint8_t* cross = pGrid->GetColumnMask (x, item.posY, offset, length);
+		if (cross == nullptr || length <= 1) continue;
+
+		int j = 0;
+		while (j < length && cross [j] == '*') j ++;
+		if (j == length) continue;
+
+		letters [i].flags &= pDict->MatchingLetters (cross, offset);
+		if (letters [i].flags == 0) return 0;
+	}
+
+	return pDict->CountMatches (mask, letters, ORDER_MATCH_LIMIT);
+}
+
+
+// ===========================================================================
+/// \brief	Dynamic order: forget the match count of an item and of the items 
+///			sharing a crossword with it, as its content changed
+///
+/// \param	idxItem		Item index
+// ===========================================================================
+void SolverStatic::InvalidateMatchesAround (int idxItem)
+{
+	items [idxItem].numMatches = -1;
+	for (int k = crossStart [idxItem]; k < crossStart [idxItem + 1]; k++) items [crossItem [k]].numMatches = -1;
 }
 
 
@@ -496,8 +805,11 @@ void SolverStatic::AddCurrentItem ()
 ///
 /// \param	item	Target item
 // ===========================================================================
-void SolverStatic::SaveCandidatesToGrid (const StaticItem &item)
+void SolverStatic::SaveCandidatesToGrid (StaticItem &item)
 {
+	// The letters this item can still take may have changed
+	item.numMatches = -1;
+
 	for (int i = 0; i < item.length; i++)
 	{
 		Box* box = pGrid->operator ()(item.posX +i, item.posY);
@@ -583,6 +895,410 @@ void SolverStatic::ResetCandidatesAround (const StaticItem &item)
 
 
 
+// ===========================================================================
+/// \brief	Put the word of an item on the grid and propagate the letter candidates
+///			it narrows. Everything is undone if a box is left without any letter.
+///
+/// \param	item	Target item
+///
+/// \return	True if the word stays on the grid
+// ===========================================================================
+bool SolverStatic::PlaceItem (StaticItem &item)
+{
+	STAT (auto propagateStart = std::chrono::steady_clock::now ());
+
+	item.trailMark = trailLength;
+	pGrid->AddWord (item.posX, item.posY, 'H', item.word);
+	ResetCandidatesAround (item);
+
+	bool result = PropagateItem (item);
+	if (result == false)
+	{
+		RestoreTrail (item.trailMark);
+		pGrid->RemoveWord (item.posX, item.posY, 'H');
+		STAT (stats.wipeouts ++);
+	}
+
+	STAT (stats.propagationTimeNs += ElapsedNs (propagateStart));
+	return result;
+}
+
+
+// ===========================================================================
+/// \brief	Narrow the letter candidates of all the empty boxes according to the
+///			content of the grid
+///
+/// \return	False if a box is left without any letter
+// ===========================================================================
+bool SolverStatic::PropagateAll ()
+{
+	STAT (auto propagateStart = std::chrono::steady_clock::now ());
+	stamp ++;
+
+	for (int y = 0; y < mSy; y ++)
+	{
+		for (int x = 0; x < mSx; x ++)
+		{
+			Box* box = pGrid->operator ()(x, y);
+			if (box->IsBloc () == true) continue;
+
+			if (box->GetLetter () == 0) box->ResetCandidates (true);
+			QueueSlot (x, y, 'H');
+			QueueSlot (x, y, 'V');
+		}
+	}
+
+	bool result = Propagate ();
+	STAT (stats.propagationTimeNs += ElapsedNs (propagateStart));
+	return result;
+}
+
+
+// ===========================================================================
+/// \brief	Narrow the letter candidates of the boxes crossing a word that has
+///			just been put on the grid, and so on until nothing changes
+///
+/// \param	item	Item put on the grid
+///
+/// \return	False if a box is left without any letter
+// ===========================================================================
+bool SolverStatic::PropagateItem (const StaticItem &item)
+{
+	stamp ++;
+	for (int i = 0; i < item.length; i ++) QueueSlot (item.posX + i, item.posY, 'V');
+
+	return Propagate ();
+}
+
+
+// ===========================================================================
+/// \brief	Revise the slots of the queue until it is empty
+///
+/// \return	False if a box is left without any letter. The queue is emptied anyway.
+// ===========================================================================
+bool SolverStatic::Propagate ()
+{
+	bool result = true;
+	int ringSize = 2 * mSx * mSy;
+
+	while (queueLength > 0)
+	{
+		int slot = queue [queueFront];
+		queueFront = (queueFront + 1) % ringSize;
+		queueLength --;
+		queued [slot] = 0;
+
+		int start = slot / 2;
+		if (result) result = ReviseSlot (start % mSx, start / mSx, (slot & 1) ? 'V' : 'H');
+	}
+
+	return result;
+}
+
+
+// ===========================================================================
+/// \brief	Keep, in each empty box of a slot, only the letter candidates
+///			that some word fitting the slot puts there
+///
+/// Every letter the words have at a position is computed with the candidates 
+/// of all the positions, so one pass is enough to make the slot consistent.
+///
+/// \param	x, y	Slot first box
+/// \param	dir		Slot direction ('H' or 'V')
+///
+/// \return	False if a box is left without any letter
+// ===========================================================================
+bool SolverStatic::ReviseSlot (int x, int y, char dir)
+{
+	uint8_t mask [MAX_GRID_SIZE + 1];
+	LetterCandidates letters [MAX_GRID_SIZE];
+
+	int dx = (dir == 'H') ? 1 : 0;
+	int dy = 1 - dx;
+	uint64_t alphabet = LowBits (pDict->AlphabetSize ());
+
+	pGrid->BuildMask (mask, x, y, dir, false);
+	int length = (int) strlen ((const char*) mask);
+	for (int k = 0; k < length; k ++) letters [k] = pGrid->operator ()(x + k*dx, y + k*dy)->GetCandidate ();
+	STAT (stats.revisions ++);
+
+	for (int k = 0; k < length; k ++)
+	{
+		if (mask [k] != '*') continue;
+
+		uint64_t flags = letters [k].flags & pDict->MatchingLetters (mask, k, letters);
+		if (flags == 0) return false;
+		if (flags == (letters [k].flags & alphabet)) continue;
+
+		letters [k].flags = flags;
+		NarrowCandidates (x + k*dx, y + k*dy, letters [k]);
+
+		// The crossing slot must be revised in turn
+		QueueSlot (x + k*dx, y + k*dy, dir == 'H' ? 'V' : 'H');
+	}
+
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Set the letter candidates of a box, saving the previous ones in the trail
+///			the first time the box changes during the current propagation
+///
+/// \param	x, y			Box position
+/// \param	candidates		New letter candidates
+// ===========================================================================
+void SolverStatic::NarrowCandidates (int x, int y, const LetterCandidates& candidates)
+{
+	Box* box = pGrid->operator ()(x, y);
+	int idxBox = y * mSx + x;
+
+	if (boxStamp [idxBox] != stamp)
+	{
+		if (trailLength == trailSize)
+		{
+			TrailEntry* larger = new TrailEntry [2 * trailSize];
+			for (int i = 0; i < trailSize; i ++) larger [i] = trail [i];
+			delete [] trail;
+			trail = larger;
+			trailSize *= 2;
+		}
+
+		trail [trailLength].box = idxBox;
+		trail [trailLength].candidates = box->GetCandidate ();
+		trailLength ++;
+		boxStamp [idxBox] = stamp;
+	}
+
+	box->SetCandidate (candidates);
+	if (dynamicOrder) items [itemAt [idxBox]].numMatches = -1;
+}
+
+
+// ===========================================================================
+/// \brief	Add a slot to the queue of the slots to revise, unless it is already in
+///
+/// \param	x, y	Any box of the slot
+/// \param	dir		Slot direction ('H' or 'V')
+// ===========================================================================
+void SolverStatic::QueueSlot (int x, int y, char dir)
+{
+	int start, length;
+
+	if (dir == 'H')
+	{
+		const StaticItem& item = items [itemAt [y * mSx + x]];
+		start = item.posY * mSx + item.posX;
+		length = item.length;
+	}
+	else
+	{
+		int offset;
+		if (pGrid->GetColumnMask (x, y, offset, length) == nullptr) return;
+		start = (y - offset) * mSx + x;
+	}
+
+	// Single boxes are not constrained
+	if (length <= 1) return;
+
+	int slot = 2 * start + (dir == 'V' ? 1 : 0);
+	if (queued [slot] != 0) return;
+
+	queued [slot] = 1;
+	queue [(queueFront + queueLength) % (2 * mSx * mSy)] = slot;
+	queueLength ++;
+}
+
+
+// ===========================================================================
+/// \brief	Give back to the boxes the letter candidates saved in the trail
+///
+/// \param	length		Trail length to come back to
+// ===========================================================================
+void SolverStatic::RestoreTrail (int length)
+{
+	while (trailLength > length)
+	{
+		const TrailEntry& entry = trail [-- trailLength];
+		pGrid->operator ()(entry.box % mSx, entry.box / mSx)->SetCandidate (entry.candidates);
+		if (dynamicOrder) items [itemAt [entry.box]].numMatches = -1;
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Learn a nogood from an item that has no word left, if its crosswords
+///			alone explain it.
+///
+/// The crosswords whose letters are not needed for that are left out, and so are
+/// the locked letters. The items owning the remaining letters are made visible.
+///
+/// \param		item		Failing item (not on the grid)
+/// \param[out]	idxJump		Position, in the processing order, of the last item owning
+///							some letter of the nogood. -1 if none: the grid has no solution
+/// \param[out]	targetCol	Last column of that item holding such a letter
+///
+/// \return		False if the failure is not explained by the crosswords alone
+// ===========================================================================
+bool SolverStatic::RecordNoGood (const StaticItem &item, int& idxJump, int& targetCol)
+{
+	uint8_t mask [MAX_GRID_SIZE + 1];
+	LetterCandidates letters [MAX_GRID_SIZE];
+	int i, offset, length;
+
+	pGrid->BuildMask (mask, item.posX, item.posY, 'H', false);
+
+	// Letters the crosswords allow in each empty box, whatever the candidates learnt so far
+	for (i = 0; i < item.length; i ++)
+	{
+		letters [i].Reset (true);
+		if (mask [i] != '*') continue;
+
+		const uint8_t* cross = pGrid->GetColumnMask (item.posX + i, item.posY, offset, length);
+		if (cross != nullptr && length > 1) letters [i].flags = pDict->MatchingLetters (cross, offset);
+	}
+	if (pDict->CountMatches (mask, letters, 1) > 0) return false;
+
+	// Free the crosswords one by one, as long as the item keeps having no word
+	for (i = 0; i < item.length; i ++)
+	{
+		if (letters [i].flags == (uint64_t) -1) continue;
+
+		uint64_t constraint = letters [i].flags;
+		letters [i].Reset (true);
+		if (pDict->CountMatches (mask, letters, 1) > 0) letters [i].flags = constraint;
+	}
+
+	// Nogood made of the letters put by the other items in the remaining crosswords
+	NoGood noGood;
+	noGood.key = 14695981039346656037ULL;
+	noGood.numPairs = 0;
+
+	for (i = 0; i < item.length; i ++)
+	{
+		if (letters [i].flags == (uint64_t) -1) continue;
+
+		int x = item.posX + i;
+		pGrid->GetColumnMask (x, item.posY, offset, length);
+		for (int y = item.posY - offset; y < item.posY - offset + length; y ++)
+		{
+			Box* box = pGrid->operator ()(x, y);
+			if (y == item.posY || box->GetLetter () == 0 || box->IsLocked ()) continue;
+
+			items [itemAt [y * mSx + x]].visibility = true;
+			if (noGood.numPairs < NOGOOD_MAX_PAIRS)
+			{
+				noGood.boxes [noGood.numPairs] = y * mSx + x;
+				noGood.letters [noGood.numPairs] = box->GetLetter ();
+			}
+			noGood.key = (noGood.key ^ (uint64_t) (y * mSx + x)) * 1099511628211ULL;
+			noGood.key = (noGood.key ^ box->GetLetter ()) * 1099511628211ULL;
+			noGood.numPairs ++;
+		}
+	}
+
+	// Last item involved, and its last column in the nogood
+	for (idxJump = idxCurrentItem - 1; idxJump >= 0; idxJump --) if (items [order [idxJump]].visibility) break;
+
+	targetCol = -1;
+	if (idxJump >= 0)
+	{
+		const StaticItem& last = items [order [idxJump]];
+		for (i = item.length - 1; i >= 0 && targetCol < 0; i --)
+		{
+			int x = item.posX + i;
+			if (letters [i].flags == (uint64_t) -1 || x < last.posX || x >= last.posX + last.length) continue;
+
+			// Same crossword, and not a locked letter
+			pGrid->GetColumnMask (x, item.posY, offset, length);
+			int top = item.posY - offset;
+			if (last.posY >= top && last.posY < top + length && !pGrid->operator ()(x, last.posY)->IsLocked ()) targetCol = x;
+		}
+	}
+
+	// Too large conflicts are only used to backtrack
+	if (noGood.numPairs > 0 && noGood.numPairs <= NOGOOD_MAX_PAIRS)
+	{
+		if (noGood.key == 0) noGood.key = 1;
+		StoreNoGood (noGood);
+	}
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Put a nogood in the store, in place of the one at its location, and
+///			have it watched by all the items owning some of its letters
+///
+/// \param	noGood		Nogood to store
+// ===========================================================================
+void SolverStatic::StoreNoGood (const NoGood& noGood)
+{
+	int entry = (int) ((noGood.key >> 32) & (noGoodsSize - 1));
+	if (noGoods [entry].key == noGood.key) return;
+
+	noGoods [entry] = noGood;
+	STAT (stats.noGoods ++);
+
+	for (int k = 0; k < noGood.numPairs; k ++)
+	{
+		int idxItem = itemAt [noGood.boxes [k]];
+		NoGoodWatch* itemWatches = watches + idxItem * NOGOOD_WATCHES;
+		int count = numWatches [idxItem];
+
+		// Already watched through another letter ?
+		int j = (count < NOGOOD_WATCHES) ? count : NOGOOD_WATCHES;
+		while (-- j >= 0) if (itemWatches [j].entry == entry && itemWatches [j].key == noGood.key) break;
+		if (j >= 0) continue;
+
+		// Ring of the last nogoods
+		itemWatches [count % NOGOOD_WATCHES].entry = entry;
+		itemWatches [count % NOGOOD_WATCHES].key = noGood.key;
+		numWatches [idxItem] = (count + 1 < 2 * NOGOOD_WATCHES) ? count + 1 : NOGOOD_WATCHES;
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Check the word of an item doesn't complete any nogood it watches
+///
+/// \param	item	Target item (not on the grid)
+///
+/// \return	False if the word must be rejected
+// ===========================================================================
+bool SolverStatic::CheckNoGoods (StaticItem &item)
+{
+	int idxItem = (int) (&item - items);
+	const NoGoodWatch* itemWatches = watches + idxItem * NOGOOD_WATCHES;
+	int count = (numWatches [idxItem] < NOGOOD_WATCHES) ? numWatches [idxItem] : NOGOOD_WATCHES;
+	int first = item.posY * mSx + item.posX;
+
+	for (int j = 0; j < count; j ++)
+	{
+		const NoGood& noGood = noGoods [itemWatches [j].entry];
+		if (noGood.key != itemWatches [j].key) continue;
+
+		int k;
+		for (k = 0; k < noGood.numPairs; k ++)
+		{
+			int box = noGood.boxes [k];
+			uint8_t letter = (box >= first && box < first + item.length) ?
+				item.word [box - first] : pGrid->operator ()(box % mSx, box / mSx)->GetLetter ();
+			if (letter != noGood.letters [k]) break;
+		}
+
+		if (k == noGood.numPairs)
+		{
+			item.noGoodRejects = true;
+			STAT (stats.noGoodRejections ++);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
 // ===========================================================================
 /// \brief	Check if it is still possible to put words on the grid crossing a given word
 ///
@@ -598,8 +1314,6 @@ void SolverStatic::ResetCandidatesAround (const StaticItem &item)
 // ===========================================================================
 bool SolverStatic::CheckItemCross (StaticItem &item, int *pBestPos)
 {
-	uint8_t word [MAX_GRID_SIZE + 1];
-
 	// Go through the whole word
 	for (int i = 0; i < item.length; i ++)
 	{
@@ -607,12 +1321,17 @@ bool SolverStatic::CheckItemCross (StaticItem &item, int *pBestPos)
 		if (item.IsCrossTested (i, item.word[i]) == true) continue;
 		
 		// Update mask with the letter that would be at the intersection
-		// ('item' is not on the grid, so the mask should be updated)
+		// ('item' is not on the grid, so the mask should be updated, then restored)
 		if (crossMasks [i].len <= 1) continue;
-		crossMasks [i].mask [crossMasks [i].backOffset] = item.word [i];
+		uint8_t* pCross = crossMasks [i].mask + crossMasks [i].backOffset;
+		uint8_t gridLetter = *pCross;
+		*pCross = item.word [i];
+		bool exists = maskCache.Exists (crossMasks [i].mask);
+		*pCross = gridLetter;
+		STAT (stats.crossChecks ++);
 
 		// Can we find a word ?
-		if (pDict->FindEntry (word, crossMasks [i].mask) == true)
+		if (exists == true)
 		{
 			item.SetCrossCandidate (i, item.word [i], true);
 			continue;
@@ -649,11 +1368,15 @@ void SolverStatic::BuildCrossMasks (StaticItem &item)
 		int x = item.posX + i;
 		int y = item.posY;
 
-		// Compute mask for the crossword, along with its offset relative to 'item'
-		crossMasks [i].backOffset = pGrid->BuildMask (crossMasks [i].mask, x, y, 'V', true);
-		int len = -1;
-		while (crossMasks [i].mask [++len]);
-		crossMasks [i].len = len;
+		// Get the crossword mask tracked by the grid, along with its offset relative to 'item'
+		crossMasks [i].mask = pGrid->GetColumnMask (x, y, crossMasks [i].backOffset, crossMasks [i].len);
+
+		// No crossword on a void box
+		if (crossMasks [i].mask == nullptr)
+		{
+			crossMasks [i].len = 0;
+			continue;
+		}
 
 		// Check the crossword is not already completely defined, if so skip it
 		int j = 0;
@@ -679,6 +1402,7 @@ void SolverStatic::BuildWordList ()
 	// Allocate memory and actually build the list
 	items = new StaticItem [numItems];
 	BuildWords (items, numItems);
+	BuildCrossGraph ();
 
 	// Compute list order
 	int idxLast = -1;
@@ -700,15 +1424,52 @@ void SolverStatic::BuildWordList ()
 		items [idxLast].processOrder = processOrder ++;
 
 		// Update strength of all the words not already selected
-		for (int i = 0; i < numItems; i++)
+		for (int k = crossStart [idxLast]; k < crossStart [idxLast + 1]; k++)
 		{
-			if (items [i].processOrder >= 0) continue;
-			items [i].connectionStrength += AreDependant (items [idxLast], items [i], nullptr);
+			StaticItem& item = items [crossItem [k]];
+			if (item.processOrder >= 0) continue;
+			item.connectionStrength += PopCount (crossMask [k]);
 		}
 	} 
 
-	// Sort word list according to their process order
+	// Sort word list according to their process order.
+	// The crossing graph follows the new item indices
 	SortWordList (items, numItems);
+	BuildCrossGraph ();
+
+	// Letter candidates of all the items, sized to their length, in a single pool
+	int numCandidates = 0;
+	for (int i = 0; i < numItems; i++) numCandidates += 2 * items [i].length;
+
+	candidates = new LetterCandidates [numCandidates];
+	LetterCandidates* pool = candidates;
+	for (int i = 0; i < numItems; i++)
+	{
+		items [i].Attach (pool);
+		pool += 2 * items [i].length;
+	}
+
+	// Processing order, set at each solver start
+	order = new int [numItems];
+
+	// Propagation queue (each slot at most once) and trail, that grows if needed
+	queue = new int [2 * mSx * mSy];
+	queued = new uint8_t [2 * mSx * mSy];
+	memset (queued, 0, 2 * mSx * mSy);
+	queueFront = queueLength = 0;
+
+	trailSize = mSx * mSy;
+	trail = new TrailEntry [trailSize];
+	trailLength = 0;
+
+	boxStamp = new uint64_t [mSx * mSy];
+	memset (boxStamp, 0, sizeof (uint64_t) * mSx * mSy);
+	stamp = 0;
+
+	// Nogoods watched by each item
+	watches = new NoGoodWatch [numItems * NOGOOD_WATCHES];
+	numWatches = new int [numItems];
+	for (int i = 0; i < numItems; i++) numWatches [i] = 0;
 }
 
 
@@ -864,70 +1625,221 @@ void SolverStatic::SortWordList (StaticItem wordList [], int listLength)
 
 
 // ===========================================================================
-/// \brief	Detect if two words see each other through a common crossword
-/// 
-/// \param		item1			First word/slot to test
-/// \param		item2			Second word/slot to test
-/// \param[out]	dependencyMask	Mask (relative to item1), giving dependency
-///								between both items. 
-///								'*' / '.' means dependency / no dependency for this letter
+/// \brief	Build the graph of the slots seeing each other through a common crossword
 ///
-/// \return		Number of dependent letters
+/// Two slots see each other at a given column if they are both in the same vertical
+/// run of non black boxes.
 // ===========================================================================
-int SolverStatic::AreDependant (const StaticItem &item1, const StaticItem &item2, uint8_t* dependencyMask)
+void SolverStatic::BuildCrossGraph ()
 {
-	unsigned char i1_xStart, i1_y, i1_xEnd;
-	unsigned char i2_xStart, i2_y, i2_xEnd;
-	int connect = 0;
-	int i, j;
+	int x, y, i, k;
+
+	delete [] crossStart;
+	delete [] crossItem;
+	delete [] crossMask;
+	delete [] itemAt;
 
-	// Start and end coordinates for item 1
-	i1_xEnd = i1_xStart = item1.posX;
-	i1_y = item1.posY;
-	i1_xEnd += item1.length -1;
+	// Item covering each box (-1 for black boxes), kept for the propagation
+	itemAt = new int [mSx * mSy];
+	for (i = 0; i < mSx * mSy; i ++) itemAt [i] = -1;
+	for (i = 0; i < numItems; i ++)
+		for (k = 0; k < items [i].length; k ++) itemAt [items [i].posY * mSx + items [i].posX + k] = i;
 
-	// Start and end coordinates for item 2
-	i2_xEnd = i2_xStart = item2.posX;
-	i2_y = item2.posY;
-	i2_xEnd += item2.length -1;
+	// Upper bound of the number of neighbours of each slot: other boxes of the vertical runs
+	crossStart = new int [numItems + 1];
+	for (i = 0; i <= numItems; i ++) crossStart [i] = 0;
 
-	// Clear mask
-	if (dependencyMask != nullptr) 
+	for (x = 0; x < mSx; x ++)
 	{
-		for (i = 0; i < item1.length; i++)
-			dependencyMask [i] = '.';
-		for (; i < item2.posX + item2.length - item1.posX; i++)
-			dependencyMask [i] = 0;
+		for (y = 0; y < mSy; )
+		{
+			int y1 = y;
+			while (y1 < mSy && itemAt [y1 * mSx + x] >= 0) y1 ++;
+			for (int j = y; j < y1; j ++) crossStart [itemAt [j * mSx + x] + 1] += y1 - y - 1;
+			y = y1 + 1;
+		}
 	}
+	for (i = 0; i < numItems; i ++) crossStart [i + 1] += crossStart [i];
 
-	// Assume words are horizontal and check overlapping
-	if ( (i1_xEnd >= i2_xStart) && (i1_xStart <= i2_xEnd) ) 
-	{	
-		// Start and end Coordinates of the adjacent letters
-		int s = (i1_xStart > i2_xStart) ? i1_xStart : i2_xStart;
-		int e = (i1_xEnd < i2_xEnd) ? i1_xEnd : i2_xEnd;
-		int step = (i1_y < i2_y) ? 1 : -1;
+	// Fill in one entry per (slot, neighbour, column)
+	int* fill = new int [numItems];
+	crossItem = new int [crossStart [numItems]];
+	crossMask = new uint64_t [crossStart [numItems]];
+	for (i = 0; i < numItems; i ++) fill [i] = crossStart [i];
 
-		// Check each boxes for the adjacent letters
-		for (i = s; i <= e; i ++)
+	for (x = 0; x < mSx; x ++)
+	{
+		for (y = 0; y < mSy; )
 		{
-			// Test the vertical path between both words
-			for (j = i1_y +step; j != i2_y; j+= step)
+			int y1 = y;
+			while (y1 < mSy && itemAt [y1 * mSx + x] >= 0) y1 ++;
+			for (int j1 = y; j1 < y1; j1 ++)
 			{
-				if ( (*pGrid) (i, j)->IsBloc () ) break;
+				int a = itemAt [j1 * mSx + x];
+
+				// Slots longer than 64 boxes cannot be filled anyway, their far columns share the last bit
+				int col = x - items [a].posX;
+				if (col > 63) col = 63;
+
+				for (int j2 = y; j2 < y1; j2 ++)
+				{
+					if (j2 == j1) continue;
+					crossItem [fill [a]] = itemAt [j2 * mSx + x];
+					crossMask [fill [a]] = 1ULL << col;
+					fill [a] ++;
+				}
 			}
+			y = y1 + 1;
+		}
+	}
 
-			// If no block in between
-			if (j == i2_y) 
+	// Sort the neighbours of each slot and merge the duplicates
+	int numEntries = 0;
+	for (i = 0; i < numItems; i ++)
+	{
+		int start = crossStart [i];
+		int end = crossStart [i + 1];
+		crossStart [i] = numEntries;
+
+		for (k = start + 1; k < end; k ++)
+		{
+			int item = crossItem [k];
+			uint64_t mask = crossMask [k];
+			int j = k;
+			for (; j > start && crossItem [j - 1] > item; j --)
 			{
-				// Mark the mask with a '*'
-				if (dependencyMask != nullptr) dependencyMask [i - i1_xStart] = '*';
-				connect ++;
-			}		
+				crossItem [j] = crossItem [j - 1];
+				crossMask [j] = crossMask [j - 1];
+			}
+			crossItem [j] = item;
+			crossMask [j] = mask;
 		}
-	} // if
 
-	return connect;
+		for (k = start; k < end; k ++)
+		{
+			if (numEntries > crossStart [i] && crossItem [numEntries - 1] == crossItem [k])
+				crossMask [numEntries - 1] |= crossMask [k];
+			else
+			{
+				crossItem [numEntries] = crossItem [k];
+				crossMask [numEntries] = crossMask [k];
+				numEntries ++;
+			}
+		}
+	}
+	crossStart [numItems] = numEntries;
+
+	delete [] fill;
+}
+
+
+// ===========================================================================
+/// \brief	Detect if two words see each other through a common crossword
+/// 
+/// \param		idx1			Index of the first word/slot to test
+/// \param		idx2			Index of the second word/slot to test
+///
+/// \return		Dependency mask (relative to item1): bit i is set if the letter i
+///				of item1 sees item2. Null if there is no dependency.
+// ===========================================================================
+uint64_t SolverStatic::AreDependant (int idx1, int idx2) const
+{
+	int lo = crossStart [idx1];
+	int hi = crossStart [idx1 + 1];
+
+	// Neighbours are sorted
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (crossItem [mid] < idx2) lo = mid + 1;
+		else hi = mid;
+	}
+
+	if (lo < crossStart [idx1 + 1] && crossItem [lo] == idx2) return crossMask [lo];
+	return 0;
+}
+
+
+// ===========================================================================
+/// \brief	Tell if the grid to solve has the same black boxes layout as the one
+///			our slot list has been built for
+// ===========================================================================
+bool SolverStatic::IsSameSkeleton () const
+{
+	if (skeleton == nullptr || items == nullptr) return false;
+	if (skeletonSx != mSx || skeletonSy != mSy) return false;
+
+	// Fingerprint first, then exact comparison
+	uint64_t key = 14695981039346656037ULL;
+	for (int y = 0; y < mSy; y ++)
+		for (int x = 0; x < mSx; x ++)
+			key = (key ^ (*pGrid) (x, y)->IsBloc ()) * 1099511628211ULL;
+	if (key != skeletonKey) return false;
+
+	for (int y = 0; y < mSy; y ++)
+		for (int x = 0; x < mSx; x ++)
+			if (skeleton [y * mSx + x] != (uint8_t) (*pGrid) (x, y)->IsBloc ()) return false;
+
+	return true;
+}
+
+
+// ===========================================================================
+/// \brief	Remember the black boxes layout our slot list has been built for
+// ===========================================================================
+void SolverStatic::SaveSkeleton ()
+{
+	skeletonSx = mSx;
+	skeletonSy = mSy;
+	skeleton = new uint8_t [mSx * mSy];
+	skeletonKey = 14695981039346656037ULL;
+
+	for (int y = 0; y < mSy; y ++)
+	{
+		for (int x = 0; x < mSx; x ++)
+		{
+			skeleton [y * mSx + x] = (*pGrid) (x, y)->IsBloc ();
+			skeletonKey = (skeletonKey ^ skeleton [y * mSx + x]) * 1099511628211ULL;
+		}
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Forget the slot list, the crossing graph and their skeleton
+// ===========================================================================
+void SolverStatic::FreeSkeleton ()
+{
+	delete [] items;
+	delete [] order;
+	delete [] candidates;
+	delete [] crossStart;
+	delete [] crossItem;
+	delete [] crossMask;
+	delete [] itemAt;
+	delete [] queue;
+	delete [] queued;
+	delete [] trail;
+	delete [] boxStamp;
+	delete [] watches;
+	delete [] numWatches;
+	delete [] skeleton;
+
+	items = nullptr;
+	order = nullptr;
+	candidates = nullptr;
+	crossStart = nullptr;
+	crossItem = nullptr;
+	crossMask = nullptr;
+	itemAt = nullptr;
+	queue = nullptr;
+	queued = nullptr;
+	trail = nullptr;
+	boxStamp = nullptr;
+	watches = nullptr;
+	numWatches = nullptr;
+	skeleton = nullptr;
+	numItems = -1;
 }
 
 
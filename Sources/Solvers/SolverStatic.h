@@ -27,6 +27,17 @@
 #include "ISolver.h"
 
 
+// ===========================================================================
+// D E F I N E S
+// ===========================================================================
+
+// Largest conflict kept as a nogood, in (box, letter) pairs
+constexpr auto NOGOOD_MAX_PAIRS = 48;
+
+// Most recent nogoods checked when a word is put in a slot
+constexpr auto NOGOOD_WATCHES = 16;
+
+
 
 // ###########################################################################
 //
@@ -38,9 +49,33 @@
 
 struct CrossMask
 {
-	uint8_t mask [MAX_GRID_SIZE + 1];
-	int len;
-	int backOffset;
+	uint8_t* mask;			///< Crossword mask, tracked by the grid
+	int len;				///< Crossword length (0: nothing to check)
+	int backOffset;			///< Offset of the crossing box in the crossword
+};
+
+
+struct TrailEntry
+{
+	int box;						///< Box whose letter candidates have been narrowed (y * width + x)
+	LetterCandidates candidates;	///< Letter candidates before that
+};
+
+
+/// Letters some boxes cannot hold all together, as a slot has no word left then
+struct NoGood
+{
+	uint64_t key;							///< Fingerprint of the pairs (0: free entry)
+	int numPairs;							///< Number of (box, letter) pairs
+	int boxes [NOGOOD_MAX_PAIRS];			///< Boxes (y * width + x)
+	uint8_t letters [NOGOOD_MAX_PAIRS];		///< Letter of each box
+};
+
+
+struct NoGoodWatch
+{
+	int entry;			///< Nogood entry in the store
+	uint64_t key;		///< Nogood fingerprint, to detect the entry has been reused since
 };
 
 
@@ -56,6 +91,7 @@ class SolverStatic : public ISolver
 private:
 
 	class StaticItem;
+	class Parallel;
 
 
 public:
@@ -64,16 +100,26 @@ public:
 	~SolverStatic ();
 
 	void SetHeurestic (bool state, int backTreshold);
+	void SetNumThreads (int numThreads) { this->numThreads = numThreads; }
+	void SetDynamicOrder (bool state) { this->dynamicOrder = state; }
+	void SetPropagation (Propagation propagation) { this->propagation = propagation; }
+	void SetNoGoods (int capacity);
 		
 	void Solve_Start (Grid &grid, const Dictionary &dico);
 	Status Solve_Step (int32_t maxTimeMs, int32_t maxSteps);
 	void Solve_Stop ();
 
+	SolverStats GetStats () const;
+
 private:
 
 	void AddCurrentItem ();
+	void SelectNextItem ();
+	int CountItemMatches (const StaticItem &item) const;
+	void InvalidateMatchesAround (int idxItem);
 	void BackTrack ();
-	int BackTrackStep (int idxTarget, int& targetCol, int idx);
+	int BackTrackStep (int idxTarget, int& targetCol, int idx, bool chronological);
+	void RemoveItem (int idx);
 	
 	bool ChangeItem (StaticItem &item, int colToChange, unsigned int* pNumAttempts);
 	bool ChangeItemWord (StaticItem &item, uint8_t mask [], int unvalidatedIdx, bool strict);
@@ -83,27 +129,79 @@ private:
 	void BuildWordList ();
 	int BuildWords (StaticItem pList [], int listLength);
 	void SortWordList (StaticItem pList [], int listLength);
-	int AreDependant (const StaticItem &item1, const StaticItem &item2, uint8_t* dependencyMask);
+	void BuildCrossGraph ();
+	uint64_t AreDependant (int idx1, int idx2) const;
+
+	bool IsSameSkeleton () const;
+	void SaveSkeleton ();
+	void FreeSkeleton ();
 
 	int FindWordToStart (StaticItem pList [], int listLength);
 	int FindWordNext (StaticItem pList [], int listLength);
 	
-	void SaveCandidatesToGrid (const StaticItem &iItem);
+	void SaveCandidatesToGrid (StaticItem &item);
 	void LoadCandidatesFromGrid (StaticItem &item);
 	void ResetCandidatesAround (const StaticItem &item);
+
+	bool PlaceItem (StaticItem &item);
+	bool PropagateAll ();
+	bool PropagateItem (const StaticItem &item);
+	bool Propagate ();
+	bool ReviseSlot (int x, int y, char dir);
+	void NarrowCandidates (int x, int y, const LetterCandidates& candidates);
+	void QueueSlot (int x, int y, char dir);
+	void RestoreTrail (int length);
+
+	bool RecordNoGood (const StaticItem &item, int& idxJump, int& targetCol);
+	void StoreNoGood (const NoGood& noGood);
+	bool CheckNoGoods (StaticItem &item);
 	
 
 private:
 
 	StaticItem* items;						///< All the horizontal slots to resolve
+	LetterCandidates* candidates;			///< Letter candidates storage of all the items
 	CrossMask crossMasks [MAX_GRID_SIZE];	///< Cross masks for the current item to solve
 	
 	int numItems;							///< Number of words to place on the grid
 	int idxCurrentItem;						///< Current slot we are currently resolving											
+	int* order;								///< Processing order: 'order [i]' is the index of the i-th item placed on the grid
+
+	// Slots crossing graph: for each item, the items seeing it through a common crossword (CSR layout)
+	int* crossStart;						///< First neighbour of each item ('numItems' + 1 entries)
+	int* crossItem;							///< Neighbour item index, sorted for each item
+	uint64_t* crossMask;					///< Columns (relative to the item) through which the neighbour is seen
+
+	// Skeleton the slot list and the crossing graph have been built for
+	uint64_t skeletonKey;					///< Skeleton fingerprint
+	uint8_t* skeleton;						///< Black boxes map of the skeleton
+	int skeletonSx, skeletonSy;				///< Skeleton size
 	
 	// Heurestic
 	bool heurestic;
 	int stepBack;
+	bool dynamicOrder;						///< Pick the most constrained slot after each placement, instead of the static order
+
+	// Letter candidates propagation
+	Propagation propagation;				///< How far the candidates are narrowed after each word placement
+	int* itemAt;							///< Item covering each box (-1: black box)
+	int* queue;								///< Slots to revise, as (start box index * 2 + vertical)
+	uint8_t* queued;						///< Tells which slots are in the queue
+	int queueFront, queueLength;			///< Queue content, in a ring of 2 entries by box
+	TrailEntry* trail;						///< Narrowed candidates, to restore them when a word is removed
+	int trailLength, trailSize;				///< Number of entries in the trail, and its capacity
+	uint64_t* boxStamp;						///< Propagation run that last saved each box in the trail
+	uint64_t stamp;							///< Current propagation run
+
+	// Nogoods: conflicts learnt when a slot has no word left, forgotten at each solver start
+	NoGood* noGoods;						///< Hashed store, each nogood replacing the one at its place
+	int noGoodsSize;						///< Store size (power of 2, 0: no nogood recording)
+	NoGoodWatch* watches;					///< For each item, the last nogoods involving its boxes ('NOGOOD_WATCHES' entries)
+	int* numWatches;						///< Number of nogoods each item has been given to watch
+
+	// Parallel search
+	int numThreads;							///< Number of threads exploring the search tree (<= 1: this one only)
+	Parallel* parallel;						///< Parallel search in progress, if any
 };
 
 
@@ -0,0 +1,70 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		Bits.h
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Bit manipulation helpers on 64 bits values
+// ###########################################################################
+
+#ifndef __BITS__H
+#define __BITS__H
+
+#include <stdint.h>
+
+
+// ===========================================================================
+/// \brief	Count the number of bits set in a 64 bits value
+// ===========================================================================
+static inline int PopCount (uint64_t v)
+{
+#if defined (__GNUC__) || defined (__clang__)
+	return __builtin_popcountll (v);
+#else
+	v = v - ((v >> 1) & 0x5555555555555555ULL);
+	v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+	v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int) ((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+// ===========================================================================
+/// \brief	Return the index of the lowest bit set in a (non null) 64 bits value
+// ===========================================================================
+static inline int CountTrailingZeros (uint64_t v)
+{
+#if defined (__GNUC__) || defined (__clang__)
+	return __builtin_ctzll (v);
+#else
+	int n = 0;
+	while ((v & 1) == 0) { v >>= 1; n ++; }
+	return n;
+#endif
+}
+
+
+// ===========================================================================
+/// \brief	Return a 64 bits value with the 'n' lowest bits set
+// ===========================================================================
+static inline uint64_t LowBits (int n)
+{
+	return n >= 64 ? (uint64_t) -1 : (1ULL << n) - 1;
+}
+
+
+#endif
@@ -0,0 +1,96 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file		Random.h
+/// \author		Jean-Sebastien Gonsette
+///
+/// \brief		Small and fast pseudo random number generator (xoshiro256**)
+// ###########################################################################
+
+#ifndef __RANDOM__H
+#define __RANDOM__H
+
+#include <stdint.h>
+
+
+// ###########################################################################
+//
+// P R O T O T Y P E S
+//
+// ###########################################################################
+
+/// Pseudo random number generator with its own state, so that each user 
+/// gets a reproducible sequence whatever the other threads do.
+/// (xoshiro256** by D. Blackman and S. Vigna, seeded with splitmix64)
+class Random
+{
+
+public :
+
+	Random (uint64_t seed = 0) { Seed (seed); }
+
+	// ===========================================================================
+	/// \brief	Restart the sequence from a given seed
+	// ===========================================================================
+	void Seed (uint64_t seed)
+	{
+		for (int i = 0; i < 4; i ++)
+		{
+			uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			state [i] = z ^ (z >> 31);
+		}
+	}
+
+	// ===========================================================================
+	/// \brief	Return the next 64 bits random value
+	// ===========================================================================
+	uint64_t Next ()
+	{
+		uint64_t result = Rotl (state [1] * 5, 7) * 9;
+		uint64_t t = state [1] << 17;
+
+		state [2] ^= state [0];
+		state [3] ^= state [1];
+		state [1] ^= state [2];
+		state [0] ^= state [3];
+		state [2] ^= t;
+		state [3] = Rotl (state [3], 45);
+
+		return result;
+	}
+
+	// ===========================================================================
+	/// \brief	Return a random value in the range [0..n-1] (n > 0)
+	// ===========================================================================
+	uint32_t Below (uint32_t n)
+	{
+		return (uint32_t) (((Next () >> 32) * n) >> 32);
+	}
+
+private :
+
+	static uint64_t Rotl (uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+private :
+
+	uint64_t state [4];		///< Generator state
+};
+
+
+#endif
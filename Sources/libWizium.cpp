@@ -61,6 +61,31 @@ LibHandle WIZ_CreateInstance (const Config& config)
 }
 
 
+// ===========================================================================
+/// \brief	Create a sperate application instance, using a shared dictionary
+///
+/// The instance uses the dictionary read-only: it can only be modified 
+/// through the dictionary handle. Instances sharing a dictionary can run on 
+/// different threads, but, as for any instance, their creation and destruction
+/// must be serialized by the caller.
+///
+/// \param	config		Instance configuration options (dictionary settings are ignored)
+/// \param	dictionary	Dictionary handle, as returned by DIC_Create
+/// \return	LibHandle on the instance, 0 if the dictionary is unknown
+// ===========================================================================
+LibHandle WIZ_CreateInstanceWithDictionary (const Config& config, LibHandle dictionary)
+{
+	Library::Module *module;
+	Library::SharedDictionary *shared;
+
+	if (dictionary == 0) return 0;
+	shared = reinterpret_cast<Library::SharedDictionary*> (dictionary);
+
+	module = Library::GetInstance ().CreateInstance (config, shared);
+	return reinterpret_cast<LibHandle> (module);
+}
+
+
 // ===========================================================================
 /// \brief	Destroy an application instance
 ///
@@ -75,24 +100,59 @@ void WIZ_DestroyInstance (LibHandle instance)
 }
 
 
+// ===========================================================================
+/// \brief	Create a dictionary that several instances can share
+///
+/// Its handle can be given to any DIC_ function in place of an instance handle.
+/// Its references are counted atomically, but dictionaries and instances must
+/// still be created and destroyed one at a time by the caller.
+///
+/// \param	config		Dictionary configuration (alphabet size, max word length and layout)
+/// \return	LibHandle on the dictionary
+// ===========================================================================
+LibHandle DIC_Create (const Config& config)
+{
+	Library::SharedDictionary *dictionary;
+
+	dictionary = Library::GetInstance ().CreateDictionary (config);
+	return reinterpret_cast<LibHandle> (dictionary);
+}
+
+
+// ===========================================================================
+/// \brief	Destroy a dictionary handle. 
+///
+/// The dictionary memory is freed once all the instances using it are destroyed too.
+///
+/// \param	dictionary	Dictionary to destroy
+// ===========================================================================
+void DIC_Destroy (LibHandle dictionary)
+{
+	Library::SharedDictionary *shared;
+	shared = reinterpret_cast<Library::SharedDictionary*> (dictionary);
+
+	Library::GetInstance ().DestroyDictionary (shared);
+}
+
+
 // ===========================================================================
 /// \brief	Flush the dictionary content
 ///
-/// \param	instance		Instance to flush
+/// \param	instance		Target instance or dictionary
 // ===========================================================================
 void DIC_Clear (LibHandle instance)
 {
-	Library::Module *module;
-	module = reinterpret_cast<Library::Module*> (instance);
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, true);
 
-	Library::GetInstance ().ClearDictionary (module);
+	Library::GetInstance ().ClearDictionary (dictionary);
 }
 
 
 // ===========================================================================
 /// \brief	Add words to the dictionary
 ///
-/// \param		instance		Target module
+/// \param		instance		Target instance or dictionary
 /// \param		entries			Array of word entries to add to the dictionary
 /// \param		numEntries		Number of words in the list
 ///
@@ -100,17 +160,74 @@ void DIC_Clear (LibHandle instance)
 // ===========================================================================
 int32_t DIC_AddEntries (LibHandle instance, const uint8_t entries [], int32_t numEntries)
 {
-	Library::Module *module;
-	module = reinterpret_cast<Library::Module*> (instance);
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, true);
 
-	return Library::GetInstance ().AddDictionaryEntries (module, entries, -1, numEntries);
+	return Library::GetInstance ().AddDictionaryEntries (dictionary, entries, -1, numEntries);
+}
+
+
+// ===========================================================================
+/// \brief	Load a whole word list file in the dictionary
+///
+/// \param		instance		Target instance or dictionary
+/// \param		path			Text file with one word per line. Case doesn't matter.
+///								Lines with other characters than letters, or too long, are rejected.
+/// \param[out]	numRejected		Number of lines that have been rejected
+///
+/// \return		Number of words added to the dictionary, -1 if the file cannot be read
+// ===========================================================================
+int32_t DIC_LoadFile (LibHandle instance, const char* path, int32_t& numRejected)
+{
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, true);
+
+	return Library::GetInstance ().LoadDictionaryFile (dictionary, path, &numRejected);
+}
+
+
+// ===========================================================================
+/// \brief	Save the dictionary content in a binary image file, 
+///			much faster to load than a word list
+///
+/// \param		instance		Target instance or dictionary
+/// \param		path			File to write
+///
+/// \return		True in case of success
+// ===========================================================================
+bool DIC_SaveImage (LibHandle instance, const char* path)
+{
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
+
+	return Library::GetInstance ().SaveDictionaryImage (dictionary, path);
+}
+
+
+// ===========================================================================
+/// \brief	Replace the dictionary content by an image file written by DIC_SaveImage.
+///
+/// The file is mapped in memory and used in place, its pages being shared by all the
+/// processes loading it.
+///
+/// \param		instance		Target instance or dictionary
+/// \param		path			Image file. Must have been saved with the same alphabet size and max word length.
+///
+/// \return		True in case of success
+// ===========================================================================
+bool DIC_LoadImage (LibHandle instance, const char* path)
+{
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, true);
+
+	return Library::GetInstance ().LoadDictionaryImage (dictionary, path);
 }
 
 
 // ===========================================================================
 /// \brief	Find a word matching a mask, as part of an interative procedure
 ///
-/// \param		instance	Target Instance
+/// \param		instance	Target instance or dictionary
 /// \param[out]	result		Array to write the matching word (must be as long as the mask length)
 /// \param		mask		Mask enabling to force some letters. 
 ///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
@@ -122,17 +239,17 @@ int32_t DIC_AddEntries (LibHandle instance, const uint8_t entries [], int32_t nu
 // ===========================================================================
 bool DIC_FindEntry (LibHandle instance, uint8_t result [], const uint8_t mask [], const uint8_t startWord [])
 {
-	Library::Module *module;
-	module = reinterpret_cast<Library::Module*> (instance);
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
 
-	return Library::GetInstance ().FindDictionaryEntry (module, result, mask, startWord);
+	return Library::GetInstance ().FindDictionaryEntry (dictionary, result, mask, startWord);
 }
 
 
 // ===========================================================================
 /// \brief	Find a random word matching a mask
 ///
-/// \param		instance	Target Instance
+/// \param		instance	Target instance or dictionary
 /// \param[out]	result		Array to write the matching word (must be as long as the mask length)
 /// \param		mask		Mask enabling to force some letters. 
 ///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
@@ -143,23 +260,64 @@ bool DIC_FindEntry (LibHandle instance, uint8_t result [], const uint8_t mask []
 // ===========================================================================
 bool DIC_FindRandomEntry (LibHandle instance, uint8_t result [], const uint8_t mask [])
 {
-	Library::Module *module;
-	module = reinterpret_cast<Library::Module*> (instance);
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
+
+	return Library::GetInstance ().FindRandomDictionaryEntry (dictionary, result, mask);
+}
+
 
-	return Library::GetInstance ().FindRandomDictionaryEntry (module, result, mask);
+// ===========================================================================
+/// \brief	Tell if at least one word matches a mask, without retrieving it
+///
+/// \param		instance	Target instance or dictionary
+/// \param		mask		Mask enabling to force some letters. 
+///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
+///							Exception for '*' which means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+///
+/// \return		True if a match exists
+// ===========================================================================
+bool DIC_Exists (LibHandle instance, const uint8_t mask [])
+{
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
+
+	return Library::GetInstance ().DictionaryEntryExists (dictionary, mask);
+}
+
+
+// ===========================================================================
+/// \brief	Count the words matching a mask
+///
+/// \param		instance	Target instance or dictionary
+/// \param		mask		Mask enabling to force some letters. 
+///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
+///							Exception for '*' which means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+/// \param		limit		If > 0, counting stops as soon as this number of matches is reached
+///
+/// \return		Number of matching words (at most 'limit', if given)
+// ===========================================================================
+int32_t DIC_CountMatches (LibHandle instance, const uint8_t mask [], int32_t limit)
+{
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
+
+	return Library::GetInstance ().CountDictionaryEntries (dictionary, mask, limit);
 }
 
 
 // ===========================================================================
 /// \brief	Return the number of words in the dictionary
 ///
-/// \param		instance	Target Instance
+/// \param		instance	Target instance or dictionary
 // ===========================================================================
 uint32_t DIC_GetNumWords (LibHandle instance)
 {
-	Library::Module *module;
-	module = reinterpret_cast<Library::Module*> (instance);
-	return Library::GetInstance ().GetNumDictionaryWords (module);
+	Library::SharedDictionary *dictionary;
+	dictionary = Library::GetInstance ().GetDictionary (instance, false);
+	return Library::GetInstance ().GetNumDictionaryWords (dictionary);
 }
 
 
@@ -256,6 +414,64 @@ void SOLVER_Start (LibHandle instance, const SolverConfig& solverConfig)
 }
 
 
+// ===========================================================================
+/// \brief	Start the grid generation process with several solvers racing on parallel threads.
+///
+/// Solver i uses the seed 'seed + i' and works on its own copy of the grid, all of them
+/// sharing the instance dictionary. SOLVER_Step runs them all; the first one completing
+/// the grid stops the others and its result becomes the instance grid.
+///
+/// \param	instance			Target Instance
+/// \param	sovlerConfg			Solver configuration parameters
+/// \param	numThreads			Number of racing solvers. <= 0: one per hardware thread
+// ===========================================================================
+void SOLVER_StartPortfolio (LibHandle instance, const SolverConfig& solverConfig, int32_t numThreads)
+{
+	Library::Module *module;
+	module = reinterpret_cast<Library::Module*> (instance);
+	Library::GetInstance ().SolverStartPortfolio (module, solverConfig, numThreads);
+}
+
+
+// ===========================================================================
+/// \brief	Tell which solver of a portfolio completed the grid
+///
+/// \param	instance			Target Instance
+/// \param[out]	solverConfig	Configuration of the winner solver (untouched if none)
+///
+/// \return	Index of the winner solver, -1 if none
+// ===========================================================================
+int32_t SOLVER_GetPortfolioWinner (LibHandle instance, SolverConfig& solverConfig)
+{
+	Library::Module *module;
+	module = reinterpret_cast<Library::Module*> (instance);
+	return Library::GetInstance ().GetPortfolioWinner (module, &solverConfig);
+}
+
+
+// ===========================================================================
+/// \brief	Generate several grids with the current grid layout, in a single call.
+///
+/// Grid i is generated with the seed 'seed + i'. The instance grid is left untouched.
+/// With 'numThreads' > 1 in the solver configuration, grids are generated in parallel.
+///
+/// \param	instance			Target Instance
+/// \param	sovlerConfg			Solver configuration parameters
+/// \param	count				Number of grids to generate
+/// \param[out]	outBuffer		Buffer receiving the grids one after the other, each one in the
+///								GRID_Read format. MUST be big enough to hold (count x WIDTH x HEIGHT) values.
+/// \param	maxTimeMsPerGrid	>=0: Maximum time to spend on a grid [ms]. -1: No limit
+///
+/// \return	Number of grids that were completely filled
+// ===========================================================================
+int32_t SOLVER_GenerateBatch (LibHandle instance, const SolverConfig& solverConfig, int32_t count, uint8_t outBuffer [], int32_t maxTimeMsPerGrid)
+{
+	Library::Module *module;
+	module = reinterpret_cast<Library::Module*> (instance);
+	return Library::GetInstance ().SolverGenerateBatch (module, solverConfig, count, outBuffer, maxTimeMsPerGrid);
+}
+
+
 // ===========================================================================
 /// \brief	Continue the grid generation process.
 ///
@@ -277,6 +493,23 @@ void SOLVER_Step (LibHandle instance, int32_t maxTimeMs, int32_t maxSteps, Statu
 }
 
 
+// ===========================================================================
+/// \brief	Get the statistics counters of the grid generation process, since its start.
+///
+/// With several threads (parallel search, portfolio or batch), counters are summed up.
+/// All counters are zero if the library is compiled with WIZIUM_STATS set to 0.
+///
+/// \param	instance			Target Instance
+/// \param[out]	stats			Statistics counters
+// ===========================================================================
+void SOLVER_GetStats (LibHandle instance, SolverStats& stats)
+{
+	Library::Module *module;
+	module = reinterpret_cast<Library::Module*> (instance);
+	stats = Library::GetInstance ().GetSolverStats (module);
+}
+
+
 // ===========================================================================
 /// \brief	Stop the grid generation process
 // ===========================================================================
@@ -80,6 +80,14 @@ typedef struct
 }
 Version;
 
+/// Memory layout of the dictionary
+typedef enum
+{
+	DENSE = 0,					///< Trie nodes with one entry per letter. Fast to build, big memory footprint
+	COMPACT = 1					///< Trie nodes with a letter bitmap and packed entries. Small memory footprint
+}
+DictionaryLayout;
+
 /// Instance configuration
 typedef struct
 {
@@ -88,6 +96,7 @@ typedef struct
 								///< sequence of letters that are in the range [1..alphabetSize].
 	int32_t maxWordLength;		///< Max word length of any word in a grid. 
 								///< This number fixes the size of any pointer to word entries
+	DictionaryLayout dictionaryLayout;	///< Memory layout of the dictionary
 }
 Config;
 
@@ -110,6 +119,23 @@ typedef enum
 }
 BlackMode;
 
+/// Order in which the static solver fills the grid slots
+typedef enum
+{
+	STATIC_ORDER = 0,		///< Order fixed before solving: longest slot first, then the most connected ones
+	FAIL_FIRST = 1,			///< After each word placement, the slot with the fewest words fitting its crosswords
+}
+SlotOrder;
+
+/// Propagation of the letters each empty box can still take, after each word placement
+typedef enum
+{
+	NO_PROPAGATION = 0,		///< Only the crosswords of the word itself are checked
+	ARC_CONSISTENCY = 1,	///< Each box keeps the letters some word of its two slots still allows,
+							///< narrowed from slot to slot until nothing changes
+}
+Propagation;
+
 /// Solver configuration
 typedef struct
 {
@@ -117,6 +143,12 @@ typedef struct
 	int32_t maxBlackBoxes;		///< Max number of black cases that can be added to the grid
 	int32_t heuristicLevel;		///< Heurisitic level (<=0: no heuristic)
 	BlackMode blackMode;		///< Rule for the generation of black boxes
+	int32_t numThreads;			///< Static solver only (maxBlackBoxes == 0): number of threads
+								///< exploring the search tree. <= 1: single threaded
+	SlotOrder slotOrder;		///< Static solver only: order in which the slots are filled
+	Propagation propagation;	///< Static solver only: propagation of the letters allowed in the empty boxes
+	int32_t maxNoGoods;			///< Static solver only: number of conflicts remembered to avoid them
+								///< and to backtrack straight to their cause. <= 0: none
 }
 SolverConfig;
 
@@ -128,6 +160,31 @@ typedef struct
 }
 Status;
 
+/// Solver statistics, accumulated since the solver start.
+/// All zero if the library is compiled with WIZIUM_STATS set to 0.
+typedef struct
+{
+	uint64_t fillSearches;			///< Dictionary searches to find a word for a slot
+	uint64_t crossChecks;			///< Crosswords existence checks
+	uint64_t blockProbes;			///< Existence checks done to probe a black box location (dynamic solver)
+	uint64_t cacheHits;				///< Existence checks answered by the mask cache
+	uint64_t cacheMisses;			///< Existence checks that needed a dictionary search
+	uint64_t densityRejections;		///< Black box locations rejected by the density rule (dynamic solver)
+	uint64_t backtracks;			///< Number of times the solver had to backtrack
+	uint64_t backtrackDepth [8];	///< Backtracks by number of words removed: 0-1, 2, 3-4, 5-8, 9-16, 17-32, 33-64, more
+	uint64_t removedWords;			///< Words removed from the grid while backtracking
+	uint64_t revisions;				///< Slots whose letter candidates have been revised by the propagation
+	uint64_t wipeouts;				///< Words rejected because the propagation left a box without any letter
+	uint64_t noGoods;				///< Conflicts recorded as nogoods
+	uint64_t noGoodRejections;		///< Words rejected because they complete a nogood
+	uint64_t stepTimeNs;			///< Time spent in the solver steps [ns]
+	uint64_t fillTimeNs;			///< Part of it spent searching words for the slots [ns]
+	uint64_t crossTimeNs;			///< Part of it spent checking the crosswords [ns]
+	uint64_t backtrackTimeNs;		///< Part of it spent backtracking, including the searches it triggers [ns]
+	uint64_t propagationTimeNs;		///< Part of it spent propagating the letter candidates [ns]
+}
+SolverStats;
+
 
 // ###########################################################################
 //
@@ -138,13 +195,21 @@ Status;
 API void WIZ_Init (Version &version);
 
 API LibHandle WIZ_CreateInstance (const Config& config);
+API LibHandle WIZ_CreateInstanceWithDictionary (const Config& config, LibHandle dictionary);
 API void WIZ_DestroyInstance (LibHandle instance);
 
+API LibHandle DIC_Create (const Config& config);
+API void DIC_Destroy (LibHandle dictionary);
 API void DIC_Clear (LibHandle instance);
 API uint32_t DIC_GetNumWords (LibHandle instance);
 API int32_t DIC_AddEntries (LibHandle instance, const uint8_t entries [], int32_t numEntries);
+API int32_t DIC_LoadFile (LibHandle instance, const char* path, int32_t& numRejected);
+API bool DIC_SaveImage (LibHandle instance, const char* path);
+API bool DIC_LoadImage (LibHandle instance, const char* path);
 API bool DIC_FindEntry (LibHandle instance, uint8_t result [], const uint8_t mask [], const uint8_t startWord []);
 API bool DIC_FindRandomEntry (LibHandle instance, uint8_t result [], const uint8_t mask []);
+API bool DIC_Exists (LibHandle instance, const uint8_t mask []);
+API int32_t DIC_CountMatches (LibHandle instance, const uint8_t mask [], int32_t limit);
 
 API void GRID_SetSize (LibHandle instance, uint8_t width, uint8_t height);
 API void GRID_SetBox (LibHandle instance, uint8_t x, uint8_t y, BoxType type);
@@ -153,7 +218,11 @@ API void GRID_Read (LibHandle instance, uint8_t grid []);
 API void GRID_Erase (LibHandle instance);
 
 API void SOLVER_Start (LibHandle instance, const SolverConfig& solver);
+API void SOLVER_StartPortfolio (LibHandle instance, const SolverConfig& solver, int32_t numThreads);
+API int32_t SOLVER_GetPortfolioWinner (LibHandle instance, SolverConfig& solver);
+API int32_t SOLVER_GenerateBatch (LibHandle instance, const SolverConfig& solver, int32_t count, uint8_t outBuffer [], int32_t maxTimeMsPerGrid);
 API void SOLVER_Step (LibHandle instance, int32_t maxTimeMs, int32_t maxSteps, Status& status);
+API void SOLVER_GetStats (LibHandle instance, SolverStats& stats);
 API void SOLVER_Stop (LibHandle instance);
 
 #endif
@@ -21,6 +21,7 @@
 // ###########################################################################
 
 #include "library.Module.h"
+#include "library.Portfolio.h"
 
 
 // ###########################################################################
@@ -31,12 +32,27 @@
 
 // ===========================================================================
 /// \brief	Constructor
+///
+/// \param	config		Instance configuration options
+/// \param	dictionary	Dictionary to share. If null, the module creates its own dictionary
+///						according to the configuration.
 // ===========================================================================
-Library::Module::Module (const Config& config) : dictionary (config.alphabetSize, config.maxWordLength)
+Library::Module::Module (const Config& config, SharedDictionary* dictionary)
 {
-	alphabetSize = config.alphabetSize;
-	maxWordLength = config.maxWordLength;
+	if (dictionary != nullptr)
+	{
+		dictionary->Acquire ();
+		this->dictionary = dictionary;
+		dictionaryShared = true;
+	}
+	else
+	{
+		this->dictionary = new SharedDictionary (config);
+		dictionaryShared = false;
+	}
+
 	currentSolver = &solverDyn;
+	portfolio = nullptr;
 	next = nullptr;
 }
 
@@ -46,7 +62,8 @@ Library::Module::Module (const Config& config) : dictionary (config.alphabetSize
 // ===========================================================================
 Library::Module::~Module ()
 {
-
+	delete portfolio;
+	SharedDictionary::Release (dictionary);
 }
 
 
@@ -63,6 +80,10 @@ ISolver& Library::Module::GetSolver (const SolverConfig& config)
 	if (config.maxBlackBoxes == 0)
 	{
 		this->solverStat.SetSeed (config.seed);
+		this->solverStat.SetNumThreads (config.numThreads);
+		this->solverStat.SetDynamicOrder (config.slotOrder == SlotOrder::FAIL_FIRST);
+		this->solverStat.SetPropagation (config.propagation);
+		this->solverStat.SetNoGoods (config.maxNoGoods);
 
 		if (config.heuristicLevel > 0)
 			this->solverStat.SetHeurestic (true, config.heuristicLevel -1);
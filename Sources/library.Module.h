@@ -24,6 +24,7 @@
 #define LIBRARY_MODULE_H
 
 #include "library.h"
+#include "library.SharedDictionary.h"
 #include "Grid/Grid.h"
 #include "Dictionary/Dictionary.h"
 #include "Solvers/SolverDynamic.h"
@@ -42,14 +43,15 @@ class Library::Module
 
 public:
 
-	Module (const Config& config);
+	Module (const Config& config, SharedDictionary* dictionary = nullptr);
 	~Module ();
 
 	Module (const Module&) = delete;
 	Module& operator = (const Module&) = delete;
 
-	Dictionary& GetDictionary () { return dictionary; }
-	const Dictionary& GetDictionary () const { return dictionary; }
+	Dictionary& GetDictionary () { return dictionary->GetDictionary (); }
+	const Dictionary& GetDictionary () const { return dictionary->GetDictionary (); }
+	bool IsDictionaryShared () const { return dictionaryShared; }
 
 	Grid& GetGrid () { return grid; }
 	const Grid& GetGrid () const { return grid; }
@@ -59,15 +61,14 @@ public:
 
 private:
 
-	Grid grid;					///< The grid we work on
-	Dictionary dictionary;		///< The dictionary we work with
-	SolverDynamic solverDyn;	///< The dynamic solver (can add black boxes)
-	SolverStatic solverStat;	///< The static solver (no black box addition)
-	
-	int32_t alphabetSize;		///< Alphabet size we work with
-	int32_t maxWordLength;		///< Max word length
+	Grid grid;						///< The grid we work on
+	SharedDictionary* dictionary;	///< The dictionary we work with (we hold a reference on it)
+	bool dictionaryShared;			///< True if the dictionary is shared with other instances (read-only)
+	SolverDynamic solverDyn;		///< The dynamic solver (can add black boxes)
+	SolverStatic solverStat;		///< The static solver (no black box addition)
 
 	ISolver* currentSolver;		///< Pointer to current solver
+	Portfolio* portfolio;		///< Racing solvers, when started with SolverStartPortfolio
 
 	mutable const Module *next;			///< For modules chaining
 
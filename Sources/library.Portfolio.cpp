@@ -0,0 +1,238 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file Library.Portfolio.cpp
+///
+/// \brief Several solvers racing on the same grid, on parallel threads
+// ###########################################################################
+
+#include <chrono>
+#include <thread>
+#include "library.Portfolio.h"
+#include "library.Module.h"
+
+
+// ===========================================================================
+// D E F I N E S
+// ===========================================================================
+
+/// Max time a solver runs before checking if another one has already won [ms]
+constexpr auto PORTFOLIO_SLICE_MS = 5;
+
+
+// ###########################################################################
+//
+// P U B L I C
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Constructor. Start all the solvers of the portfolio.
+///
+/// \param	owner		Module whose grid must be solved
+/// \param	dictionary	Dictionary of this module, shared with all the solvers
+/// \param	config		Solver configuration. Solver i uses the seed 'config.seed + i'.
+/// \param	numThreads	Number of solvers to race. <= 0: one per hardware thread
+// ===========================================================================
+Library::Portfolio::Portfolio (Module& owner, SharedDictionary* dictionary, const SolverConfig& config, int32_t numThreads) :
+	owner (owner), winner (-1)
+{
+	if (numThreads <= 0) numThreads = static_cast<int32_t> (std::thread::hardware_concurrency ());
+	if (numThreads <= 0) numThreads = 1;
+
+	numWorkers = numThreads;
+	workers = new Module* [numWorkers];
+	configs = new SolverConfig [numWorkers];
+	status = new Status [numWorkers];
+	done = new bool [numWorkers];
+
+	for (int i = 0; i < numWorkers; i ++)
+	{
+		Config unused = {};
+		configs [i] = config;
+		configs [i].seed = config.seed + i;
+		configs [i].numThreads = 1;
+
+		status [i].counter = 0;
+		status [i].fillRate = 0;
+		done [i] = false;
+
+		// Each solver works on its own copy of the grid
+		workers [i] = new Module (unused, dictionary);
+		workers [i]->GetGrid ().Copy (owner.GetGrid ());
+
+		ISolver& solver = workers [i]->GetSolver (configs [i]);
+		solver.Solve_Start (workers [i]->GetGrid (), workers [i]->GetDictionary ());
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Destructor
+// ===========================================================================
+Library::Portfolio::~Portfolio ()
+{
+	for (int i = 0; i < numWorkers; i ++) delete workers [i];
+
+	delete [] workers;
+	delete [] configs;
+	delete [] status;
+	delete [] done;
+}
+
+
+// ===========================================================================
+/// \brief	Let all the solvers race for some time.
+///
+/// Once a solver succeeds, the others stop and the owner grid receives the solution.
+/// Otherwise, the owner grid shows the most advanced solver.
+///
+/// \param		maxTimeMs:		>=0: Maximum time to spend [ms] before returning.
+///								-1: No stop criteria
+/// \param		maxSteps:		>=0: Maximum word tries of each solver before returning
+///								-1: No stop criteria
+///
+/// \return		Generation status. The counter is the sum of all the solvers counters.
+// ===========================================================================
+Status Library::Portfolio::Step (int32_t maxTimeMs, int32_t maxSteps)
+{
+	Status result;
+	int best = -1;
+
+	// Run the race, one thread per solver
+	if (winner < 0)
+	{
+		std::thread* threads = new std::thread [numWorkers];
+		for (int i = 0; i < numWorkers; i ++) 
+			threads [i] = std::thread (&Portfolio::Run, this, i, maxTimeMs, maxSteps);
+		for (int i = 0; i < numWorkers; i ++) 
+			threads [i].join ();
+		delete [] threads;
+	}
+
+	// Gather results
+	result.counter = 0;
+	result.fillRate = 0;
+	for (int i = 0; i < numWorkers; i ++)
+	{
+		result.counter += status [i].counter;
+		if (done [i]) continue;
+		if (best < 0 || status [i].fillRate > status [best].fillRate) best = i;
+	}
+
+	if (winner >= 0) best = winner;
+	if (best >= 0)
+	{
+		result.fillRate = status [best].fillRate;
+		owner.GetGrid ().Copy (workers [best]->GetGrid ());
+	}
+
+	// All solvers failed: the grid is left erased, as after a single solver failure
+	else owner.GetGrid ().Copy (workers [0]->GetGrid ());
+
+	return result;
+}
+
+
+// ===========================================================================
+/// \brief	Tell which solver completed the grid first
+///
+/// \param[out]	pConfig		If not null, receives the configuration of the winner
+///
+/// \return		Index of the winner solver, -1 if none has completed the grid yet
+// ===========================================================================
+int32_t Library::Portfolio::GetWinner (SolverConfig* pConfig) const
+{
+	int32_t idx = winner;
+	if (idx >= 0 && pConfig != nullptr) *pConfig = configs [idx];
+	return idx;
+}
+
+
+// ===========================================================================
+/// \brief	Return the statistics counters of all the solvers, summed up
+// ===========================================================================
+SolverStats Library::Portfolio::GetStats () const
+{
+	SolverStats stats = {};
+	for (int i = 0; i < numWorkers; i ++) ISolver::AddStats (stats, workers [i]->GetSolver ().GetStats ());
+	return stats;
+}
+
+
+
+// ###########################################################################
+//
+// P R I V A T E
+//
+// ###########################################################################
+
+// ===========================================================================
+/// \brief	Thread body of one solver. Run by slices, until time or steps are 
+///			exhausted or some solver has completed the grid.
+///
+/// \param		idx				Solver index
+/// \param		maxTimeMs:		>=0: Maximum time to spend [ms] before returning.
+///								-1: No stop criteria
+/// \param		maxSteps:		>=0: Maximum word tries before returning
+///								-1: No stop criteria
+// ===========================================================================
+void Library::Portfolio::Run (int idx, int32_t maxTimeMs, int32_t maxSteps)
+{
+	ISolver& solver = workers [idx]->GetSolver ();
+	uint64_t initCounter = status [idx].counter;
+	auto start = std::chrono::steady_clock::now ();
+	bool stepped = false;
+
+	while (done [idx] == false && winner < 0)
+	{
+		// Size the next slice according to the remaining budget. Like a single
+		// solver, run at least one slice per call, even with no budget
+		int32_t sliceMs = PORTFOLIO_SLICE_MS;
+		int32_t sliceSteps = -1;
+
+		if (maxTimeMs >= 0)
+		{
+			auto elapsed = std::chrono::steady_clock::now () - start;
+			int64_t remaining = maxTimeMs - std::chrono::duration_cast<std::chrono::milliseconds> (elapsed).count ();
+			if (remaining <= 0 && stepped) break;
+			if (remaining < sliceMs) sliceMs = static_cast<int32_t> (remaining > 0 ? remaining : 0);
+		}
+		if (maxSteps >= 0)
+		{
+			int64_t remaining = maxSteps - static_cast<int64_t> (status [idx].counter - initCounter);
+			if (remaining <= 0 && stepped) break;
+			sliceSteps = static_cast<int32_t> (remaining > 0 ? remaining : 0);
+		}
+
+		status [idx] = solver.Solve_Step (sliceMs, sliceSteps);
+		stepped = true;
+
+		// Success: we are the winner if nobody was faster
+		if (status [idx].fillRate == 100)
+		{
+			int32_t none = -1;
+			winner.compare_exchange_strong (none, idx);
+			break;
+		}
+
+		// Failure
+		if (solver.HasFailed ()) done [idx] = true;
+	}
+}
+
+// End
@@ -0,0 +1,69 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file Library.Portfolio.h
+///
+/// \brief Several solvers racing on the same grid, on parallel threads
+// ###########################################################################
+
+#ifndef LIBRARY_PORTFOLIO_H
+#define LIBRARY_PORTFOLIO_H
+
+#include <atomic>
+#include "library.h"
+
+
+// ###########################################################################
+//
+// T Y P E S
+//
+// ###########################################################################
+
+/// Portfolio of solvers working on copies of a module grid. Each one has its
+/// own seed and they all share the read-only dictionary of the module. The first
+/// solver to complete the grid wins and stops the others.
+class Library::Portfolio
+{
+public:
+
+	Portfolio (Module& owner, SharedDictionary* dictionary, const SolverConfig& config, int32_t numThreads);
+	~Portfolio ();
+
+	Portfolio (const Portfolio&) = delete;
+	Portfolio& operator = (const Portfolio&) = delete;
+
+	Status Step (int32_t maxTimeMs, int32_t maxSteps);
+	int32_t GetWinner (SolverConfig* pConfig) const;
+	SolverStats GetStats () const;
+
+private:
+
+	void Run (int idx, int32_t maxTimeMs, int32_t maxSteps);
+
+private:
+
+	Module& owner;				///< Module whose grid we solve
+	int numWorkers;				///< Number of racing solvers (one thread each)
+	Module** workers;			///< One module per solver, with its own grid copy
+	SolverConfig* configs;		///< Configuration of each solver
+	Status* status;				///< Last status of each solver
+	bool* done;					///< True when a solver has failed
+
+	std::atomic<int32_t> winner;	///< Index of the first solver that completed the grid, -1 if none
+};
+
+#endif
@@ -0,0 +1,76 @@
+// ###########################################################################
+//
+// This file is part of the Wizium distribution (https://github.com/jsgonsette/Wizium).
+// Copyright (c) 2019 Jean-Sebastien Gonsette.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 3.
+
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.If not, see <http://www.gnu.org/licenses/>.
+///
+/// \file Library.SharedDictionary.h
+///
+/// \brief A dictionary that can be used by several modules
+// ###########################################################################
+
+#ifndef LIBRARY_SHAREDDICTIONARY_H
+#define LIBRARY_SHAREDDICTIONARY_H
+
+#include "library.h"
+#include "Dictionary/Dictionary.h"
+
+#include <atomic>
+
+
+// ###########################################################################
+//
+// T Y P E S
+//
+// ###########################################################################
+
+/// Reference counted dictionary. Each module using it holds one reference, 
+/// and so does the user handle of a dictionary created with DIC_Create.
+class Library::SharedDictionary
+{
+	friend class Library;
+
+public:
+
+	SharedDictionary (const Config& config) :
+		dictionary (config.alphabetSize, config.maxWordLength, 
+			config.dictionaryLayout == DictionaryLayout::COMPACT ? Dictionary::COMPACT : Dictionary::DENSE)
+	{
+		maxWordLength = config.maxWordLength;
+		refCount = 1;
+		next = nullptr;
+	}
+
+	SharedDictionary (const SharedDictionary&) = delete;
+	SharedDictionary& operator = (const SharedDictionary&) = delete;
+
+	Dictionary& GetDictionary () { return dictionary; }
+	const Dictionary& GetDictionary () const { return dictionary; }
+
+	/// Take a new reference. Modules using the dictionary may be created on several threads
+	void Acquire () { refCount.fetch_add (1, std::memory_order_relaxed); }
+
+	/// Drop a reference, and delete the dictionary if it was the last one
+	static void Release (SharedDictionary* p) { if (p->refCount.fetch_sub (1, std::memory_order_acq_rel) == 1) delete p; }
+
+private:
+
+	Dictionary dictionary;		///< The dictionary content
+	int32_t maxWordLength;		///< Max word length, as configured
+	std::atomic<int> refCount;	///< Number of references on this dictionary
+
+	SharedDictionary *next;		///< For dictionaries chaining
+};
+
+#endif
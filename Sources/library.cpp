@@ -22,8 +22,13 @@
 // ###########################################################################
 
 #include <assert.h>
+#include <atomic>
+#include <thread>
 #include "library.h"
 #include "library.Module.h"
+#include "library.SharedDictionary.h"
+#include "library.Portfolio.h"
+#include "Utils/Random.h"
 
 
 // ###########################################################################
@@ -48,15 +53,24 @@ Library& Library::GetInstance ()
 // ===========================================================================
 /// \brief	Create and manage a new PPMM instance
 ///
-/// \param	config	Instance configuration options
-/// \return	New managed instance
+/// \param	config		Instance configuration options
+/// \param	dictionary	Dictionary to use, read-only. If null, the instance has its own dictionary.
+/// \return	New managed instance, null if the dictionary is unknown
 // ===========================================================================
-Library::Module* Library::CreateInstance (const Config& config)
+Library::Module* Library::CreateInstance (const Config& config, SharedDictionary* dictionary)
 {
 	Module* module;
 
+	// The dictionary must be one of ours
+	if (dictionary != nullptr)
+	{
+		const SharedDictionary* p = this->dictionaries;
+		while (p != nullptr && p != dictionary) p = p->next;
+		if (p == nullptr) return nullptr;
+	}
+
 	// Create the module
-	module = new Module (config);
+	module = new Module (config, dictionary);
 
 	// Chaining
 	module->next = this->modules;
@@ -101,22 +115,92 @@ Library::~Library ()
 		delete p;
 		p = pn;
 	}
+
+	// Drop our reference on the dictionaries
+	while (this->dictionaries != nullptr)
+	{
+		SharedDictionary* pd = this->dictionaries;
+		this->dictionaries = pd->next;
+		SharedDictionary::Release (pd);
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Create a dictionary that several instances can use
+///
+/// \param	config	Dictionary configuration (alphabet size, max word length, layout)
+/// \return	New dictionary
+// ===========================================================================
+Library::SharedDictionary* Library::CreateDictionary (const Config& config)
+{
+	SharedDictionary* dictionary = new SharedDictionary (config);
+
+	// Chaining
+	dictionary->next = this->dictionaries;
+	this->dictionaries = dictionary;
+
+	return dictionary;
+}
+
+
+// ===========================================================================
+/// \brief	Destroy a dictionary handle. 
+///
+/// The dictionary itself lives as long as some instances use it.
+///
+/// \param	dictionary	Dictionary to release
+// ===========================================================================
+void Library::DestroyDictionary (SharedDictionary* dictionary)
+{
+	SharedDictionary** pp = &this->dictionaries;
+
+	while (*pp != nullptr && *pp != dictionary) pp = &(*pp)->next;
+	if (*pp == nullptr) return;
+
+	*pp = dictionary->next;
+	SharedDictionary::Release (dictionary);
+}
+
+
+// ===========================================================================
+/// \brief	Return the dictionary targeted by a handle
+///
+/// \param	handle	Either a dictionary handle, or an instance handle
+/// \param	write	True if the dictionary is to be modified
+///
+/// \return	Dictionary. Null if the instance uses a shared dictionary that must
+///			be modified, which is only possible through the dictionary handle
+// ===========================================================================
+Library::SharedDictionary* Library::GetDictionary (LibHandle handle, bool write) const
+{
+	// Dictionary handle ?
+	for (SharedDictionary* p = this->dictionaries; p != nullptr; p = p->next)
+	{
+		if (reinterpret_cast<LibHandle> (p) == handle) return p;
+	}
+
+	// Instance handle
+	Module* module = reinterpret_cast<Module*> (handle);
+	if (write && module->IsDictionaryShared ()) return nullptr;
+	return module->dictionary;
 }
 
 
 // ===========================================================================
 /// \brief	Flush dictionary content
 // ===========================================================================
-void Library::ClearDictionary (Module* module)
+void Library::ClearDictionary (SharedDictionary* dictionary)
 {
-	module->GetDictionary ().Clear ();
+	if (dictionary == nullptr) return;
+	dictionary->GetDictionary ().Clear ();
 }
 
 
 // ===========================================================================
 /// \brief	Add words to the dictionary
 ///
-/// \param		module			Target module
+/// \param		dictionary		Target dictionary
 /// \param		tabEntries		List of words. End of list when a null caracter is 
 ///								found instead of a new word or if 'numWords' is reached
 ///								Each word is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
@@ -127,12 +211,63 @@ void Library::ClearDictionary (Module* module)
 ///
 /// \return		Number of words added to the dictionary
 // ===========================================================================
-int32_t Library::AddDictionaryEntries (Module* module, const uint8_t* tabEntries, int32_t entrySize, int32_t numWords)
+int32_t Library::AddDictionaryEntries (SharedDictionary* dictionary, const uint8_t* tabEntries, int32_t entrySize, int32_t numWords)
 {
+	if (dictionary == nullptr) return 0;
+
 	// Fall back on max word length if entry size is not specified
-	if (entrySize < 0) entrySize = module->maxWordLength;
+	if (entrySize < 0) entrySize = dictionary->maxWordLength;
+
+	return dictionary->GetDictionary ().AddEntries (tabEntries, entrySize, numWords);
+}
+
+
+// ===========================================================================
+/// \brief	Load a word list file in the dictionary
+///
+/// \param		dictionary		Target dictionary
+/// \param		path			Text file with one word per line
+/// \param[out]	pNumRejected	Number of lines that have been rejected
+///
+/// \return		Number of words added to the dictionary, -1 if the file cannot be read
+// ===========================================================================
+int32_t Library::LoadDictionaryFile (SharedDictionary* dictionary, const char* path, int32_t* pNumRejected)
+{
+	if (dictionary == nullptr)
+	{
+		if (pNumRejected != nullptr) *pNumRejected = 0;
+		return -1;
+	}
+	return dictionary->GetDictionary ().LoadFromFile (path, pNumRejected);
+}
 
-	return module->GetDictionary ().AddEntries (tabEntries, entrySize, numWords);
+
+// ===========================================================================
+/// \brief	Save the dictionary content in an image file
+///
+/// \param		dictionary		Target dictionary
+/// \param		path			File to write
+///
+/// \return		True in case of success
+// ===========================================================================
+bool Library::SaveDictionaryImage (SharedDictionary* dictionary, const char* path) const
+{
+	return dictionary->GetDictionary ().SaveImage (path);
+}
+
+
+// ===========================================================================
+/// \brief	Replace the dictionary content by an image file
+///
+/// \param		dictionary		Target dictionary
+/// \param		path			Image file
+///
+/// \return		True in case of success
+// ===========================================================================
+bool Library::LoadDictionaryImage (SharedDictionary* dictionary, const char* path)
+{
+	if (dictionary == nullptr) return false;
+	return dictionary->GetDictionary ().LoadImage (path);
 }
 
 
@@ -140,7 +275,7 @@ int32_t Library::AddDictionaryEntries (Module* module, const uint8_t* tabEntries
 /// \brief	Find a word matching a mask, with a given starting point.
 ///			This function can be called iteratively to enumerate all the words mathcing a mask.
 ///
-/// \param		module		Target module
+/// \param		dictionary	Target dictionary
 /// \param[out]	result		Array to write the matching word (must be as long as the mask length)
 /// \param		mask		Mask enabling to force some letters. 
 ///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
@@ -150,9 +285,9 @@ int32_t Library::AddDictionaryEntries (Module* module, const uint8_t* tabEntries
 ///
 /// \return		True if a match has been found
 // ===========================================================================
-bool Library::FindDictionaryEntry (Module* module, uint8_t* result, const uint8_t* mask, const uint8_t* startWord) const
+bool Library::FindDictionaryEntry (SharedDictionary* dictionary, uint8_t* result, const uint8_t* mask, const uint8_t* startWord) const
 {
-	const Dictionary& dico = module->GetDictionary ();
+	const Dictionary& dico = dictionary->GetDictionary ();
 	if (dico.FindEntry (result, mask, startWord))
 	{
 		if (dico.AlphabetSize () == 26)
@@ -169,7 +304,7 @@ bool Library::FindDictionaryEntry (Module* module, uint8_t* result, const uint8_
 // ===========================================================================
 /// \brief	Find a random word matching a mask
 ///
-/// \param		module		Target module
+/// \param		dictionary	Target dictionary
 /// \param[out]	result		Array to write the matching word (must be as long as the mask length)
 /// \param		mask		Mask enabling to force some letters. 
 ///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
@@ -178,10 +313,13 @@ bool Library::FindDictionaryEntry (Module* module, uint8_t* result, const uint8_
 ///
 /// \return		True if a match has been found
 // ===========================================================================
-bool Library::FindRandomDictionaryEntry (Module* module, uint8_t* result, const uint8_t* mask) const
+bool Library::FindRandomDictionaryEntry (SharedDictionary* dictionary, uint8_t* result, const uint8_t* mask) const
 {
-	const Dictionary& dico = module->GetDictionary ();
-	if (dico.FindRandomEntry (result, mask))
+	// Each calling thread draws from its own generator
+	static thread_local Random rng;
+
+	const Dictionary& dico = dictionary->GetDictionary ();
+	if (dico.FindRandomEntry (result, mask, rng))
 	{
 		if (dico.AlphabetSize () == 26)
 		{
@@ -194,14 +332,49 @@ bool Library::FindRandomDictionaryEntry (Module* module, uint8_t* result, const
 }
 
 
+// ===========================================================================
+/// \brief	Tell if at least one word matches a mask
+///
+/// \param		dictionary	Target dictionary
+/// \param		mask		Mask enabling to force some letters. 
+///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
+///							Exception for '*' which means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+///
+/// \return		True if a match exists
+// ===========================================================================
+bool Library::DictionaryEntryExists (SharedDictionary* dictionary, const uint8_t* mask) const
+{
+	return dictionary->GetDictionary ().Exists (mask);
+}
+
+
+// ===========================================================================
+/// \brief	Count the words matching a mask
+///
+/// \param		dictionary	Target dictionary
+/// \param		mask		Mask enabling to force some letters. 
+///							Each letter is either in the [A..Z] ASCII range or in the [1..alphabetSize] range
+///							Exception for '*' which means any letter (e.g. "*A***I**)
+///							Word length is given implicitly by the mask length.
+/// \param		limit		If > 0, counting stops as soon as this number of matches is reached
+///
+/// \return		Number of matching words
+// ===========================================================================
+int32_t Library::CountDictionaryEntries (SharedDictionary* dictionary, const uint8_t* mask, int32_t limit) const
+{
+	return dictionary->GetDictionary ().CountMatches (mask, nullptr, limit);
+}
+
+
 // ===========================================================================
 /// \brief	Return the number of words in the dictionary
 ///
-/// \param		module		Target module
+/// \param		dictionary	Target dictionary
 // ===========================================================================
-uint32_t Library::GetNumDictionaryWords (Module* module) const
+uint32_t Library::GetNumDictionaryWords (SharedDictionary* dictionary) const
 {
-	return module->GetDictionary ().GetNumWords ();
+	return dictionary->GetDictionary ().GetNumWords ();
 }
 
 
@@ -313,27 +486,7 @@ void Library::WriteGrid (Module* module, uint8_t x, uint8_t y, const uint8_t ent
 // ===========================================================================
 void Library::ReadGrid (Module* module, uint8_t grid[])
 {
-	const Grid& mgrid = module->GetGrid ();
-	int w = mgrid.GetWidth ();
-	int h = mgrid.GetHeight ();
-	uint8_t alphaSize = module->GetDictionary ().AlphabetSize ();
-
-	for (int i = 0; i < w; i++)
-	{
-		for (int j = 0; j < h; j++)
-		{
-			const Box* box = mgrid (i, j);
-			
-			if (box->IsLetter ())
-			{
-				uint8_t val = box->GetLetter ();
-				if (alphaSize == 26) grid [j * w + i] = val > 0 ? (val + 'A' - 1) : '.';
-				else grid [j * w + i] = val;
-			}
-			else if (box->IsBloc ()) grid [j * w + i] = '#';
-			else if (box->IsVoid ()) grid [j * w + i] = '-';
-		}
-	}
+	ExportGrid (module->GetGrid (), module->GetDictionary ().AlphabetSize (), grid);
 }
 
 
@@ -356,11 +509,125 @@ void Library::EraseGrid (Module* module)
 // ===========================================================================
 void Library::SolverStart (Module* module, const SolverConfig& solverConfig)
 {
+	if (module->portfolio != nullptr) SolverStop (module);
+
+	// Statistics cover the start too (word list, first propagation). The previous
+	// generation is stopped first, as it hands over its last counters when stopping
 	ISolver& solver = module->GetSolver (solverConfig);	
+	solver.Solve_Stop ();
+	solver.ResetStats ();
 	solver.Solve_Start (module->GetGrid (), module->GetDictionary ());
 }
 
 
+// ===========================================================================
+/// \brief	Start the grid generation process with several solvers racing on
+///			parallel threads. Each one has its own seed ('seed', 'seed+1', ...) and
+///			works on its own copy of the grid. The first to succeed stops the others.
+///
+/// \param	module				Target module
+/// \param	sovlerConfg			Solver configuration parameters
+/// \param	numThreads			Number of solvers. <= 0: one per hardware thread
+// ===========================================================================
+void Library::SolverStartPortfolio (Module* module, const SolverConfig& solverConfig, int32_t numThreads)
+{
+	SolverStop (module);
+	module->portfolio = new Portfolio (*module, module->dictionary, solverConfig, numThreads);
+}
+
+
+// ===========================================================================
+/// \brief	Tell which solver of a portfolio has completed the grid
+///
+/// \param		module		Target module
+/// \param[out]	pConfig		If not null, receives the configuration of the winner
+///
+/// \return		Index of the winner solver, -1 if none (or no portfolio running)
+// ===========================================================================
+int32_t Library::GetPortfolioWinner (Module* module, SolverConfig* pConfig) const
+{
+	if (module->portfolio == nullptr) return -1;
+	return module->portfolio->GetWinner (pConfig);
+}
+
+
+// ===========================================================================
+/// \brief	Generate several grids with the same layout, in a single call.
+///
+/// Grid i is generated from the current module grid with the seed 'seed + i'. 
+/// The module grid is left untouched. Solvers and caches are reused from one grid
+/// to the next. With 'numThreads' > 1, grids are generated on parallel threads.
+///
+/// \param		module				Target module
+/// \param		sovlerConfg			Solver configuration parameters
+/// \param		count				Number of grids to generate
+/// \param[out]	outBuffer			Buffer receiving the grids, one after the other, in the ReadGrid
+///									format. MUST be big enough to hold (count x WIDTH x HEIGHT) values.
+/// \param		maxTimeMsPerGrid	>=0: Maximum time to spend on a grid [ms]. -1: No limit
+///
+/// \return		Number of grids that were completely filled
+// ===========================================================================
+int32_t Library::SolverGenerateBatch (Module* module, const SolverConfig& solverConfig, int32_t count, uint8_t* outBuffer, int32_t maxTimeMsPerGrid)
+{
+	const Grid& skeleton = module->GetGrid ();
+	size_t gridSize = (size_t) skeleton.GetWidth () * skeleton.GetHeight ();
+	int numThreads = solverConfig.numThreads > 1 ? solverConfig.numThreads : 1;
+	if (numThreads > count) numThreads = count;
+
+	SolverStop (module);
+	if (count <= 0) return 0;
+
+	std::atomic<int32_t> next (0);
+	std::atomic<int32_t> numSuccess (0);
+
+	// Generate grids until there is nothing left. The first worker is the module itself
+	auto work = [&] (Module& worker)
+	{
+		Grid grid;
+		int32_t idx;
+		bool first = true;
+
+		while ((idx = next ++) < count)
+		{
+			SolverConfig config = solverConfig;
+			config.seed = solverConfig.seed + idx;
+			config.numThreads = 1;
+
+			ISolver& solver = worker.GetSolver (config);
+			if (first) solver.ResetStats ();
+			first = false;
+
+			if (GenerateGrid (solver, grid, skeleton, worker.GetDictionary (), maxTimeMsPerGrid, outBuffer + idx * gridSize))
+				numSuccess ++;
+		}
+	};
+
+	// Other workers share our dictionary
+	Module** workers = new Module* [numThreads];
+	std::thread* threads = new std::thread [numThreads];
+	for (int i = 1; i < numThreads; i ++)
+	{
+		Config unused = {};
+		workers [i] = new Module (unused, module->dictionary);
+		threads [i] = std::thread (work, std::ref (*workers [i]));
+	}
+
+	work (*module);
+
+	// Statistics of the whole batch are kept by the module solver
+	for (int i = 1; i < numThreads; i ++)
+	{
+		threads [i].join ();
+		module->GetSolver ().MergeStats (workers [i]->GetSolver ().GetStats ());
+		delete workers [i];
+	}
+	delete [] threads;
+	delete [] workers;
+
+	return numSuccess;
+}
+
+
 // ===========================================================================
 /// \brief	Continue the grid generation process.
 ///
@@ -377,6 +644,8 @@ void Library::SolverStart (Module* module, const SolverConfig& solverConfig)
 // ===========================================================================
 Status Library::SolverStep (Module* module, int32_t maxTimeMs, int32_t maxSteps)
 {
+	if (module->portfolio != nullptr) return module->portfolio->Step (maxTimeMs, maxSteps);
+
 	ISolver& solver = module->GetSolver ();
 	Status status = solver.Solve_Step (maxTimeMs, maxSteps);
 	return status;
@@ -388,11 +657,32 @@ Status Library::SolverStep (Module* module, int32_t maxTimeMs, int32_t maxSteps)
 // ===========================================================================
 void Library::SolverStop (Module* module)
 {
+	if (module->portfolio != nullptr)
+	{
+		delete module->portfolio;
+		module->portfolio = nullptr;
+		module->GetGrid ().Unlock ();
+	}
+
 	ISolver& solver = module->GetSolver ();
 	solver.Solve_Stop ();
 }
 
 
+// ===========================================================================
+/// \brief	Return the statistics counters of the current grid generation process
+///
+/// \param		module			Target module
+///
+/// \return		Counters, summed up over all the threads involved
+// ===========================================================================
+SolverStats Library::GetSolverStats (Module* module) const
+{
+	if (module->portfolio != nullptr) return module->portfolio->GetStats ();
+	return module->GetSolver ().GetStats ();
+}
+
+
 
 // ###########################################################################
 //
@@ -406,4 +696,61 @@ void Library::SolverStop (Module* module)
 Library::Library ()
 {
 	modules = nullptr;
+	dictionaries = nullptr;
+}
+
+
+// ===========================================================================
+/// \brief	Write the content of a grid in the ReadGrid format
+///
+/// \param		grid			Grid to export
+/// \param		alphabetSize	Size of the dictionary alphabet (26: ASCII letters)
+/// \param[out]	out				Buffer to get the grid content (WIDTH x HEIGHT values)
+// ===========================================================================
+void Library::ExportGrid (const Grid& grid, uint8_t alphabetSize, uint8_t out [])
+{
+	int w = grid.GetWidth ();
+	int h = grid.GetHeight ();
+
+	for (int i = 0; i < w; i++)
+	{
+		for (int j = 0; j < h; j++)
+		{
+			const Box* box = grid (i, j);
+			
+			if (box->IsLetter ())
+			{
+				uint8_t val = box->GetLetter ();
+				if (alphabetSize == 26) out [j * w + i] = val > 0 ? (val + 'A' - 1) : '.';
+				else out [j * w + i] = val;
+			}
+			else if (box->IsBloc ()) out [j * w + i] = '#';
+			else if (box->IsVoid ()) out [j * w + i] = '-';
+		}
+	}
+}
+
+
+// ===========================================================================
+/// \brief	Generate one grid from a skeleton and export it
+///
+/// \param		solver		Configured solver to use
+/// \param		grid		Work grid
+/// \param		skeleton	Grid to start from
+/// \param		dico		Dictionary to use
+/// \param		maxTimeMs	>=0: Maximum time to spend [ms]. -1: No limit
+/// \param[out]	out			Buffer to get the grid content (WIDTH x HEIGHT values)
+///
+/// \return		True if the grid has been completely filled
+// ===========================================================================
+bool Library::GenerateGrid (ISolver& solver, Grid& grid, const Grid& skeleton, const Dictionary& dico, int32_t maxTimeMs, uint8_t out [])
+{
+	grid.Copy (skeleton);
+
+	solver.Solve_Start (grid, dico);
+	Status status = solver.Solve_Step (maxTimeMs, -1);
+	ExportGrid (grid, dico.AlphabetSize (), out);
+	solver.Solve_Stop ();
+
+	return status.fillRate == 100;
 }
\ No newline at end of file
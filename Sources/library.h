@@ -25,6 +25,10 @@
 
 #include "libWizium.h"
 
+class Grid;
+class Dictionary;
+class ISolver;
+
 
 // ###########################################################################
 //
@@ -40,20 +44,35 @@ public:
 	/// Independent Map Matching module
 	class Module;
 
+	/// Dictionary that can be used by several modules
+	class SharedDictionary;
+
+	/// Solvers racing on parallel threads
+	class Portfolio;
+
 
 public:
 
 	static Library& GetInstance ();
 	~Library ();
 
-	Module* CreateInstance (const Config& config);
+	Module* CreateInstance (const Config& config, SharedDictionary* dictionary = nullptr);
 	void DestroyInstance (Module*);
 
-	void ClearDictionary (Module* module);
-	int32_t AddDictionaryEntries (Module* module, const uint8_t* tabEntries, int32_t entrySize, int32_t numWords);
-	bool FindDictionaryEntry (Module* module, uint8_t* result, const uint8_t* mask, const uint8_t* startWord) const;
-	bool FindRandomDictionaryEntry (Module* module, uint8_t* result, const uint8_t* mask) const;
-	uint32_t GetNumDictionaryWords (Module* module) const;
+	SharedDictionary* CreateDictionary (const Config& config);
+	void DestroyDictionary (SharedDictionary* dictionary);
+	SharedDictionary* GetDictionary (LibHandle handle, bool write) const;
+
+	void ClearDictionary (SharedDictionary* dictionary);
+	int32_t AddDictionaryEntries (SharedDictionary* dictionary, const uint8_t* tabEntries, int32_t entrySize, int32_t numWords);
+	int32_t LoadDictionaryFile (SharedDictionary* dictionary, const char* path, int32_t* pNumRejected);
+	bool SaveDictionaryImage (SharedDictionary* dictionary, const char* path) const;
+	bool LoadDictionaryImage (SharedDictionary* dictionary, const char* path);
+	bool FindDictionaryEntry (SharedDictionary* dictionary, uint8_t* result, const uint8_t* mask, const uint8_t* startWord) const;
+	bool FindRandomDictionaryEntry (SharedDictionary* dictionary, uint8_t* result, const uint8_t* mask) const;
+	bool DictionaryEntryExists (SharedDictionary* dictionary, const uint8_t* mask) const;
+	int32_t CountDictionaryEntries (SharedDictionary* dictionary, const uint8_t* mask, int32_t limit) const;
+	uint32_t GetNumDictionaryWords (SharedDictionary* dictionary) const;
 
 	void SetGridSize (Module* module, uint8_t width, uint8_t height);
 	void SetGridBox (Module* module, uint8_t x, uint8_t y, BoxType type);
@@ -62,14 +81,21 @@ public:
 	void EraseGrid (Module* module);
 
 	void SolverStart (Module* module, const SolverConfig& solver);
+	void SolverStartPortfolio (Module* module, const SolverConfig& solver, int32_t numThreads);
+	int32_t GetPortfolioWinner (Module* module, SolverConfig* pConfig) const;
+	int32_t SolverGenerateBatch (Module* module, const SolverConfig& solver, int32_t count, uint8_t* outBuffer, int32_t maxTimeMsPerGrid);
 	Status SolverStep (Module* module, int32_t maxTimeMs, int32_t maxSteps);
 	void SolverStop (Module* module);
+	SolverStats GetSolverStats (Module* module) const;
 
 
 private:
 
 	Library ();
 
+	static void ExportGrid (const Grid& grid, uint8_t alphabetSize, uint8_t out []);
+	static bool GenerateGrid (ISolver& solver, Grid& grid, const Grid& skeleton, const Dictionary& dico, int32_t maxTimeMs, uint8_t out []);
+
 
 private:
 
@@ -78,6 +104,9 @@ private:
 
 	/// All independant modules
 	const Module* modules;
+
+	/// All the dictionaries created with their own handle
+	SharedDictionary* dictionaries;
 };
 
 
@@ -23,6 +23,7 @@ __version__ = "1.0"
 # ############################################################################
 
 import ctypes
+import os
 import platform
 
 def is_unix_platform():
@@ -66,7 +67,8 @@ class Wizium:
         """Description of the 'Segment' structure"""
     # ============================================================================
         _fields_ = [("alphabetSize", ctypes.c_int),
-                    ("maxWordLength", ctypes.c_int)]
+                    ("maxWordLength", ctypes.c_int),
+                    ("dictionaryLayout", ctypes.c_int)]
 
     # ============================================================================
     class SolverConfig(ctypes.Structure):
@@ -75,7 +77,11 @@ class Wizium:
         _fields_ = [("seed", ctypes.c_uint),
                     ("maxBlackBoxes", ctypes.c_int),
                     ("heuristicLevel", ctypes.c_int),
-                    ("blackMode", ctypes.c_int)]
+                    ("blackMode", ctypes.c_int),
+                    ("numThreads", ctypes.c_int),
+                    ("slotOrder", ctypes.c_int),
+                    ("propagation", ctypes.c_int),
+                    ("maxNoGoods", ctypes.c_int)]
 
     # ============================================================================
     class Status(ctypes.Structure):
@@ -88,13 +94,53 @@ class Wizium:
             string = "Counter: {}\nFill rate: {}%".format (self.counter, self.fillRate)
             return string
 
+    # ============================================================================
+    class SolverStats(ctypes.Structure):
+        """Description of the 'SolverStats' structure"""
+    # ============================================================================
+        _fields_ = [("fillSearches", ctypes.c_ulonglong),
+                    ("crossChecks", ctypes.c_ulonglong),
+                    ("blockProbes", ctypes.c_ulonglong),
+                    ("cacheHits", ctypes.c_ulonglong),
+                    ("cacheMisses", ctypes.c_ulonglong),
+                    ("densityRejections", ctypes.c_ulonglong),
+                    ("backtracks", ctypes.c_ulonglong),
+                    ("backtrackDepth", ctypes.c_ulonglong * 8),
+                    ("removedWords", ctypes.c_ulonglong),
+                    ("revisions", ctypes.c_ulonglong),
+                    ("wipeouts", ctypes.c_ulonglong),
+                    ("noGoods", ctypes.c_ulonglong),
+                    ("noGoodRejections", ctypes.c_ulonglong),
+                    ("stepTimeNs", ctypes.c_ulonglong),
+                    ("fillTimeNs", ctypes.c_ulonglong),
+                    ("crossTimeNs", ctypes.c_ulonglong),
+                    ("backtrackTimeNs", ctypes.c_ulonglong),
+                    ("propagationTimeNs", ctypes.c_ulonglong)]
+
+        def __str__ (self):
+            string = "Fill searches: {}\nCross checks: {}\nBlock probes: {}\n".format (
+                self.fillSearches, self.crossChecks, self.blockProbes)
+            string += "Cache hits/misses: {}/{}\nDensity rejections: {}\n".format (
+                self.cacheHits, self.cacheMisses, self.densityRejections)
+            string += "Backtracks: {} {}\nRemoved words: {}\n".format (
+                self.backtracks, list (self.backtrackDepth), self.removedWords)
+            string += "Revisions: {}\nWipeouts: {}\n".format (self.revisions, self.wipeouts)
+            string += "Nogoods/rejections: {}/{}\n".format (self.noGoods, self.noGoodRejections)
+            string += "Time step/fill/cross/backtrack/propagation: {}/{}/{}/{}/{} ms".format (
+                self.stepTimeNs // 1000000, self.fillTimeNs // 1000000,
+                self.crossTimeNs // 1000000, self.backtrackTimeNs // 1000000,
+                self.propagationTimeNs // 1000000)
+            return string
+
 
     # ============================================================================
-    def __init__ (self, dll_path, alphabet=None):
+    def __init__ (self, dll_path, alphabet=None, layout='DENSE', dictionary=None):
         """Constructor
 
         param    dll_path        path to the libWizium dll/so file to use
-        param    alphabet        string containing all same-case characters of the alphabet"""
+        param    alphabet        string containing all same-case characters of the alphabet
+        param    layout          dictionary memory layout: 'DENSE' (fast to build) or 'COMPACT' (small footprint)
+        param    dictionary      WiziumDictionary to share (read-only) instead of having an own dictionary"""
     # ============================================================================
 
         # Link to the lPPMM dll
@@ -108,11 +154,19 @@ class Wizium:
         self._api_def = {}
         self._api_def ["WIZ_Init"] = (ctypes.c_int, [ctypes.POINTER (Wizium.Version)])
         self._api_def ["WIZ_CreateInstance"] = (ctypes.c_ulonglong, [ctypes.POINTER (Wizium.Config)])
+        self._api_def ["WIZ_CreateInstanceWithDictionary"] = (ctypes.c_ulonglong, [ctypes.POINTER (Wizium.Config), ctypes.c_ulonglong])
         self._api_def ["WIZ_DestroyInstance"] = (ctypes.c_int, [ctypes.c_ulonglong])
+        self._api_def ["DIC_Create"] = (ctypes.c_ulonglong, [ctypes.POINTER (Wizium.Config)])
+        self._api_def ["DIC_Destroy"] = (ctypes.c_int, [ctypes.c_ulonglong])
         self._api_def ["DIC_Clear"] = (ctypes.c_int, [ctypes.c_ulonglong])
         self._api_def ["DIC_AddEntries"] = (ctypes.c_int, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8), ctypes.c_int])
+        self._api_def ["DIC_LoadFile"] = (ctypes.c_int, [ctypes.c_ulonglong, ctypes.c_char_p, ctypes.POINTER (ctypes.c_int)])
+        self._api_def ["DIC_SaveImage"] = (ctypes.c_bool, [ctypes.c_ulonglong, ctypes.c_char_p])
+        self._api_def ["DIC_LoadImage"] = (ctypes.c_bool, [ctypes.c_ulonglong, ctypes.c_char_p])
         self._api_def ["DIC_FindEntry"] = (ctypes.c_bool, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8), ctypes.POINTER (ctypes.c_uint8), ctypes.POINTER (ctypes.c_uint8)])
         self._api_def ["DIC_FindRandomEntry"] = (ctypes.c_bool, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8), ctypes.POINTER (ctypes.c_uint8)])
+        self._api_def ["DIC_Exists"] = (ctypes.c_bool, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8)])
+        self._api_def ["DIC_CountMatches"] = (ctypes.c_int, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8), ctypes.c_int])
         self._api_def ["DIC_GetNumWords"] = (ctypes.c_uint, [ctypes.c_ulonglong])
         self._api_def ["GRID_SetSize"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.c_uint8, ctypes.c_uint8])
         self._api_def ["GRID_SetBox"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.c_uint8, ctypes.c_uint8, ctypes.c_int])
@@ -120,7 +174,11 @@ class Wizium:
         self._api_def ["GRID_Read"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.POINTER (ctypes.c_uint8)])
         self._api_def ["GRID_Erase"] = (ctypes.c_uint, [ctypes.c_ulonglong])
         self._api_def ["SOLVER_Start"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.POINTER (Wizium.SolverConfig)])
+        self._api_def ["SOLVER_StartPortfolio"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.POINTER (Wizium.SolverConfig), ctypes.c_int])
+        self._api_def ["SOLVER_GetPortfolioWinner"] = (ctypes.c_int, [ctypes.c_ulonglong, ctypes.POINTER (Wizium.SolverConfig)])
+        self._api_def ["SOLVER_GenerateBatch"] = (ctypes.c_int, [ctypes.c_ulonglong, ctypes.POINTER (Wizium.SolverConfig), ctypes.c_int, ctypes.POINTER (ctypes.c_uint8), ctypes.c_int])
         self._api_def ["SOLVER_Step"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.c_int, ctypes.c_int, ctypes.POINTER (Wizium.Status)])
+        self._api_def ["SOLVER_GetStats"] = (ctypes.c_uint, [ctypes.c_ulonglong, ctypes.POINTER (Wizium.SolverStats)])
         self._api_def ["SOLVER_Stop"] = (ctypes.c_uint, [ctypes.c_ulonglong])
 
         for func_name in self._api_def:
@@ -143,8 +201,11 @@ class Wizium:
             Wizium._init_done = True
 
         # Create an instance
+        self._dictionary = dictionary
         self._wiz_create_instance (
-            alphabet_size=len(alphabet) if alphabet else 0
+            alphabet_size=len(alphabet) if alphabet else 0,
+            layout=layout,
+            dictionary=dictionary
         )
         self.encoding = make_codec(alphabet)
         if self._instance == 0:
@@ -201,6 +262,56 @@ class Wizium:
         return api (instance, ctab, len (entries) - skip)
 
 
+    # ============================================================================
+    def dic_load_file (self, path):
+        """Load a whole word list file in the dictionary
+
+        path:        Text file with one word per line. Case doesn't matter.
+                    Lines with other characters than letters, or too long, are rejected.
+
+        return:        (Number of words added, number of lines rejected).
+                    Number of words added is -1 if the file cannot be read.
+        """
+    # ============================================================================
+
+        rejected = ctypes.c_int (0)
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_LoadFile"]
+        accepted = api (instance, os.fsencode (path), ctypes.byref (rejected))
+
+        return (accepted, rejected.value)
+
+
+    # ============================================================================
+    def dic_save_image (self, path):
+        """Save the dictionary content in a binary image file, much faster to load than a word list
+
+        path:        File to write
+
+        return:        True in case of success
+        """
+    # ============================================================================
+
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_SaveImage"]
+        return api (instance, os.fsencode (path))
+
+
+    # ============================================================================
+    def dic_load_image (self, path):
+        """Replace the dictionary content by an image file written by dic_save_image
+
+        path:        Image file. Must have been saved with the same alphabet size and max word length.
+
+        return:        True in case of success
+        """
+    # ============================================================================
+
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_LoadImage"]
+        return api (instance, os.fsencode (path))
+
+
     # ============================================================================
     def dic_find_random_entry (self, mask):
         """Find a random entry in the dictionary, matching a mask
@@ -266,6 +377,49 @@ class Wizium:
         else: return str (ctab, self.encoding)
 
 
+    # ============================================================================
+    def dic_exists (self, mask):
+        """Tell if at least one entry of the dictionary matches a mask
+
+        mask:        Mask to match. Each letter must either be in ['A'..'Z'] range
+                    or be a wildcard '*'. The wildcard means that any letter matches.
+
+        return:        True if a match exists
+        """
+    # ============================================================================
+
+        length = len (mask)
+        tab_mask = bytearray (length +1)
+        tab_mask [0:length] = bytearray (mask, self.encoding)
+        cmask = (ctypes.c_uint8 * (length +1)).from_buffer (tab_mask)
+
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_Exists"]
+        return api (instance, cmask)
+
+
+    # ============================================================================
+    def dic_count_matches (self, mask, limit=-1):
+        """Count the entries of the dictionary matching a mask
+
+        mask:        Mask to match. Each letter must either be in ['A'..'Z'] range
+                    or be a wildcard '*'. The wildcard means that any letter matches.
+        limit:        If > 0, counting stops as soon as this number of matches is reached
+
+        return:        Number of matching words
+        """
+    # ============================================================================
+
+        length = len (mask)
+        tab_mask = bytearray (length +1)
+        tab_mask [0:length] = bytearray (mask, self.encoding)
+        cmask = (ctypes.c_uint8 * (length +1)).from_buffer (tab_mask)
+
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_CountMatches"]
+        return api (instance, cmask, limit)
+
+
     # ============================================================================
     def dic_gen_num_words (self):
         """Return the number of words in the dictionary"""
@@ -359,7 +513,8 @@ class Wizium:
 
 
     # ============================================================================
-    def solver_start (self, seed=0, black_mode='DIAG', max_black=0, heuristic_level=-1):
+    def solver_start (self, seed=0, black_mode='DIAG', max_black=0, heuristic_level=-1, num_threads=1,
+                      slot_order='STATIC', propagation='NONE', max_nogoods=0):
         """Start the grid generation process
 
         seed            Custom seed for the generation process
@@ -369,29 +524,99 @@ class Wizium:
                         'SINGLE':
         max_black        Max. number of black boxes that can be added to the grid
         heuristic_level    Heuristic strength. -1: no heuristic
+        num_threads     Static solver only (max_black = 0): number of threads exploring the search
+        slot_order      Static solver only: 'STATIC' (fixed order) or 'FAIL_FIRST' (most constrained slot first)
+        propagation     Static solver only: 'NONE' or 'ARC' (arc consistency of the box letters after each word)
+        max_nogoods     Static solver only: number of conflicts remembered to avoid them (0: none)
         """
     # ============================================================================
 
-        assert black_mode in ('DIAG', 'ANY', 'TWO', 'SINGLE')
-
-        config = Wizium.SolverConfig ()
-        config.seed = seed
-        config.heuristicLevel = heuristic_level
-        config.maxBlackBoxes = max_black
-        if black_mode == 'DIAG':
-            config.blackMode = 3
-        elif black_mode == 'ANY':
-            config.blackMode = 0
-        elif black_mode == 'TWO':
-            config.blackMode = 2
-        elif black_mode == 'SINGLE':
-            config.blackMode = 1
+        config = self._solver_config (seed, black_mode, max_black, heuristic_level, slot_order, propagation,
+                                      max_nogoods)
+        config.numThreads = num_threads
 
         (api, proto) = self._api ["SOLVER_Start"]
         instance = ctypes.c_ulonglong (self._instance)
         api (instance, ctypes.byref (config))
 
 
+    # ============================================================================
+    def solver_start_portfolio (self, seed=0, black_mode='DIAG', max_black=0, heuristic_level=-1, num_threads=0,
+                                slot_order='STATIC', propagation='NONE', max_nogoods=0):
+        """Start the grid generation process with several solvers racing on parallel threads
+
+        seed            Seed of the first solver. Solver i uses 'seed + i'
+        black_mode      See solver_start
+        max_black       Max. number of black boxes that can be added to the grid
+        heuristic_level Heuristic strength. -1: no heuristic
+        num_threads     Number of racing solvers. 0: one per hardware thread
+        slot_order      See solver_start
+        propagation     See solver_start
+        max_nogoods     See solver_start
+        """
+    # ============================================================================
+
+        config = self._solver_config (seed, black_mode, max_black, heuristic_level, slot_order, propagation,
+                                      max_nogoods)
+
+        (api, proto) = self._api ["SOLVER_StartPortfolio"]
+        instance = ctypes.c_ulonglong (self._instance)
+        api (instance, ctypes.byref (config), num_threads)
+
+
+    # ============================================================================
+    def solver_get_portfolio_winner (self):
+        """Return the seed of the solver that completed the grid, None if none"""
+    # ============================================================================
+
+        config = Wizium.SolverConfig ()
+
+        (api, proto) = self._api ["SOLVER_GetPortfolioWinner"]
+        instance = ctypes.c_ulonglong (self._instance)
+        if api (instance, ctypes.byref (config)) < 0:
+            return None
+        return config.seed
+
+
+    # ============================================================================
+    def solver_generate_batch (self, count, seed=0, black_mode='DIAG', max_black=0, heuristic_level=-1, 
+                               num_threads=1, max_time_ms_per_grid=-1, slot_order='STATIC',
+                               propagation='NONE', max_nogoods=0):
+        """Generate several grids with the current grid layout. Grid i uses the seed 'seed + i'.
+
+        num_threads             Number of grids generated in parallel
+        max_time_ms_per_grid    Time limit of each grid. -1: no limit
+        Other parameters:       See solver_start
+
+        Return the list of grids (see grid_read) and the number of completely filled ones
+        """
+    # ============================================================================
+
+        config = self._solver_config (seed, black_mode, max_black, heuristic_level, slot_order, propagation,
+                                      max_nogoods)
+        config.numThreads = num_threads
+
+        size = self._width * self._height
+        if not size or count <= 0: return [], 0
+
+        tab = bytearray (size * count)
+        ctab = (ctypes.c_uint8 * (size * count)).from_buffer (tab)
+
+        (api, proto) = self._api ["SOLVER_GenerateBatch"]
+        instance = ctypes.c_ulonglong (self._instance)
+        num_success = api (instance, ctypes.byref (config), count, ctab, max_time_ms_per_grid)
+
+        grids = []
+        for k in range (count):
+            grid = [''] * self._height
+            for i in range (self._height):
+                offset = size*k + self._width*i
+                grid [i] = str (tab [offset: offset + self._width], self.encoding) + '\n'
+            grids.append (grid)
+
+        return grids, num_success
+
+
     # ============================================================================
     def solver_step (self, max_time_ms=-1, max_steps=-1):
         """Move a few steps in the grid generation process"""
@@ -406,6 +631,20 @@ class Wizium:
         return status
 
 
+    # ============================================================================
+    def solver_get_stats (self):
+        """Return the counters accumulated since the solver start"""
+    # ============================================================================
+
+        stats = Wizium.SolverStats ()
+
+        (api, proto) = self._api ["SOLVER_GetStats"]
+        instance = ctypes.c_ulonglong (self._instance)
+        api (instance, ctypes.byref (stats))
+
+        return stats
+
+
     # ============================================================================
     def solver_stop (self):
         """Stop the grid generation process"""
@@ -422,6 +661,33 @@ class Wizium:
     #
     # ############################################################################
 
+    # ============================================================================
+    def _solver_config (self, seed, black_mode, max_black, heuristic_level, slot_order, propagation, max_nogoods):
+    # ============================================================================
+
+        assert black_mode in ('DIAG', 'ANY', 'TWO', 'SINGLE')
+        assert slot_order in ('STATIC', 'FAIL_FIRST')
+        assert propagation in ('NONE', 'ARC')
+
+        config = Wizium.SolverConfig ()
+        config.seed = seed
+        config.heuristicLevel = heuristic_level
+        config.maxBlackBoxes = max_black
+        if black_mode == 'DIAG':
+            config.blackMode = 3
+        elif black_mode == 'ANY':
+            config.blackMode = 0
+        elif black_mode == 'TWO':
+            config.blackMode = 2
+        elif black_mode == 'SINGLE':
+            config.blackMode = 1
+        config.slotOrder = 1 if slot_order == 'FAIL_FIRST' else 0
+        config.propagation = 1 if propagation == 'ARC' else 0
+        config.maxNoGoods = max_nogoods
+
+        return config
+
+
     # ============================================================================
     def _wiz_init (self):
     # ============================================================================
@@ -434,18 +700,25 @@ class Wizium:
 
 
     # ============================================================================
-    def _wiz_create_instance (self, alphabet_size=0, max_word_length=20):
+    def _wiz_create_instance (self, alphabet_size=0, max_word_length=20, layout='DENSE', dictionary=None):
     # ============================================================================
 
+        assert layout in ('DENSE', 'COMPACT')
+
         config = Wizium.Config ()
         config.alphabetSize = alphabet_size
         config.maxWordLength = max_word_length
+        config.dictionaryLayout = 0 if layout == 'DENSE' else 1
 
         self._max_word_length = max_word_length
         self._alphabet_size = alphabet_size
 
-        (api, proto) = self._api ["WIZ_CreateInstance"]
-        self._instance = api (ctypes.byref (config))
+        if dictionary is None:
+            (api, proto) = self._api ["WIZ_CreateInstance"]
+            self._instance = api (ctypes.byref (config))
+        else:
+            (api, proto) = self._api ["WIZ_CreateInstanceWithDictionary"]
+            self._instance = api (ctypes.byref (config), ctypes.c_ulonglong (dictionary._instance))
         self._width = self._height = 0
 
 
@@ -459,6 +732,40 @@ class Wizium:
 
 
 
+# ============================================================================
+class WiziumDictionary (Wizium):
+    """Dictionary that several Wizium instances can share, read-only.
+    Only the dic_xxx functions are available."""
+# ============================================================================
+
+    # ============================================================================
+    def _wiz_create_instance (self, alphabet_size=0, max_word_length=20, layout='DENSE', dictionary=None):
+    # ============================================================================
+
+        assert layout in ('DENSE', 'COMPACT')
+
+        config = Wizium.Config ()
+        config.alphabetSize = alphabet_size
+        config.maxWordLength = max_word_length
+        config.dictionaryLayout = 0 if layout == 'DENSE' else 1
+
+        self._max_word_length = max_word_length
+        self._alphabet_size = alphabet_size
+
+        (api, proto) = self._api ["DIC_Create"]
+        self._instance = api (ctypes.byref (config))
+
+
+    # ============================================================================
+    def _wiz_destroy_instance (self):
+    # ============================================================================
+
+        instance = ctypes.c_ulonglong (self._instance)
+        (api, proto) = self._api ["DIC_Destroy"]
+        api (instance)
+
+
+
 # ============================================================================
 def make_codec(alphabet, __alphabets={}):
     """\